@@ -0,0 +1,171 @@
+#include "BatchEvaluator.h"
+#include "DenseNetwork.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+BatchEvaluator::BatchEvaluator(int groupSize, int blockSize)
+    : m_groupSize(groupSize)
+    , m_blockSize(blockSize)
+    , m_count(0)
+{}
+
+BatchEvaluator::~BatchEvaluator()
+{}
+
+int BatchEvaluator::networkCount() const
+{
+    return m_count;
+}
+
+void BatchEvaluator::pack(const QList< Network* >& networks)
+{
+    packRecords(networks, false);
+}
+
+void BatchEvaluator::packTernary(const QList< Network* >& networks)
+{
+    packRecords(networks, true);
+}
+
+void BatchEvaluator::packRecords(const QList< Network* >& networks, bool ternary)
+{
+    m_count = networks.size();
+    m_hiddenCounts.resize(m_count);
+    
+    if (ternary) {
+        m_ternaryRecords.resize(m_count * TernaryNetworkLayout::Size);
+    } else {
+        m_kernels.resize(m_count);
+        m_records.resize(m_count * NetworkLayout::Size);
+    }
+    
+    DenseNetwork dense;
+    
+    for (int n = 0; n < m_count; n++) {
+        networks[n]->toDense(&dense);
+        m_hiddenCounts[n] = dense.hiddenCount;
+        
+        if (ternary) {
+            packTernaryNetwork(dense, m_ternaryRecords.data() + n * TernaryNetworkLayout::Size);
+        } else {
+            packNetwork(dense, m_records.data() + n * NetworkLayout::Size);
+            m_kernels[n] = packedKernel(dense.hiddenCount);
+        }
+    }
+}
+
+/*
+ * The class only depends on the sign of the output neuron's sum, since the (clamped) tangent
+ * preserves it.
+ */
+void BatchEvaluator::evaluate(const QList< InputSample* >& samples, int firstNetwork, int networkCount,
+                              int firstSample, int sampleCount, char* classes) const
+{
+    int stride = samples.size();
+    
+    for (int s = firstSample; s < firstSample + sampleCount; s++) {
+        const double* x = samples[s]->attributes;
+        
+        for (int n = firstNetwork; n < firstNetwork + networkCount; n++) {
+            const double* record = m_records.constData() + n * NetworkLayout::Size;
+            double z = m_kernels[n](record, m_hiddenCounts[n], x);
+            
+            classes[n * stride + s] = (z > 0.0) ? 1 : 0;
+        }
+    }
+}
+
+void BatchEvaluator::evaluate(const TernarySampleSet& samples, int firstNetwork, int networkCount,
+                              int firstSample, int sampleCount, char* classes) const
+{
+    int stride = samples.size();
+    
+    for (int s = firstSample; s < firstSample + sampleCount; s++) {
+        const TernaryBoard& board = samples.board(s);
+        
+        for (int n = firstNetwork; n < firstNetwork + networkCount; n++) {
+            const double* record = m_ternaryRecords.constData() + n * TernaryNetworkLayout::Size;
+            double z = ternaryKernel(record, m_hiddenCounts[n], board);
+            
+            classes[n * stride + s] = (z > 0.0) ? 1 : 0;
+        }
+    }
+}
+
+void BatchEvaluator::classify(const QList< Network* >& networks, const QList< InputSample* >& samples,
+                              QVector< char >& classes)
+{
+    pack(networks);
+    classes.resize(m_count * samples.size());
+    
+    for (int first = 0; first < m_count; first += m_groupSize) {
+        TRACE_SPAN_ARG("evaluate group", "network", first);
+        int groupSize = qMin(m_groupSize, m_count - first);
+        
+        for (int block = 0; block < samples.size(); block += m_blockSize) {
+            int blockSize = qMin(m_blockSize, samples.size() - block);
+            evaluate(samples, first, groupSize, block, blockSize, classes.data());
+        }
+    }
+}
+
+void BatchEvaluator::classify(const QList< Network* >& networks, const TernarySampleSet& samples,
+                              QVector< char >& classes)
+{
+    packTernary(networks);
+    classes.resize(m_count * samples.size());
+    
+    for (int first = 0; first < m_count; first += m_groupSize) {
+        TRACE_SPAN_ARG("evaluate group", "network", first);
+        int groupSize = qMin(m_groupSize, m_count - first);
+        
+        for (int block = 0; block < samples.size(); block += m_blockSize) {
+            int blockSize = qMin(m_blockSize, samples.size() - block);
+            evaluate(samples, first, groupSize, block, blockSize, classes.data());
+        }
+    }
+}
+
+QVector< double > BatchEvaluator::averageErrors(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    QVector< char > classes;
+    QVector< double > errors(networks.size(), 0.0);
+    
+    classify(networks, samples, classes);
+    
+    for (int n = 0; n < networks.size(); n++) {
+        int wrong = 0;
+        
+        for (int s = 0; s < samples.size(); s++) {
+            if (classes[n * samples.size() + s] != (int)samples[s]->n_class) {
+                wrong++;
+            }
+        }
+        
+        errors[n] = (double)wrong / (double)samples.size();
+    }
+    
+    return errors;
+}
+
+QVector< double > BatchEvaluator::averageErrors(const QList< Network* >& networks, const TernarySampleSet& samples)
+{
+    QVector< char > classes;
+    QVector< double > errors(networks.size(), 0.0);
+    
+    classify(networks, samples, classes);
+    
+    for (int n = 0; n < networks.size(); n++) {
+        int wrong = 0;
+        
+        for (int s = 0; s < samples.size(); s++) {
+            if (classes[n * samples.size() + s] != samples.sampleClass(s)) {
+                wrong++;
+            }
+        }
+        
+        errors[n] = (double)wrong / (double)samples.size();
+    }
+    
+    return errors;
+}
@@ -0,0 +1,83 @@
+/*
+ * Evaluates many networks at once. The networks are packed one after the other into a contiguous weight
+ * tensor, each one as a fixed-size record (see FixedKernel.h) padded to HIDDEN_SIZE_MAX hidden neurons
+ * with zero weights; then each block of samples is run through a whole group of networks, so every sample
+ * is read once per group instead of once per network, while the weights of the group stay in cache.
+ * 
+ * Each network is run by the kernel specialized for its number of hidden neurons, picked when it is
+ * packed.
+ * 
+ * The result is the same class Network::predict() gives, up to rounding: the sums are done in a
+ * different order.
+ * 
+ * Samples packed into bit masks (see TernarySampleSet) are evaluated with TernaryKernel instead, from a
+ * second kind of record, packed only for them.
+ */
+
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include <QList>
+#include <QVector>
+
+#include "Network.h"
+#include "FixedKernel.h"
+#include "TernaryKernel.h"
+#include "TernarySampleSet.h"
+#include "ProblemInfo.h"
+
+class BatchEvaluator
+{
+public:
+    /*
+     * Networks are evaluated in groups of @groupSize, on blocks of @blockSize samples.
+     */
+    explicit BatchEvaluator(int groupSize = 16, int blockSize = 64);
+    virtual ~BatchEvaluator();
+    
+    /*
+     * Copies the weights of the networks into the tensors; must be called again if they change. Packed
+     * samples are evaluated from the records packTernary() makes instead, and the other samples from the
+     * records of pack(): each call replaces the networks of the other.
+     */
+    void pack(const QList< Network* > &);
+    void packTernary(const QList< Network* > &);
+    
+    /*
+     * Classifies a range of samples with a range of the packed networks: the class given by network n
+     * to sample s goes in classes[n * samples.size() + s]. Only reads the tensors, so more threads can
+     * evaluate disjoint ranges at the same time.
+     */
+    void evaluate(const QList< InputSample* > &, int firstNetwork, int networkCount,
+                  int firstSample, int sampleCount, char* classes) const;
+    void evaluate(const TernarySampleSet &, int firstNetwork, int networkCount,
+                  int firstSample, int sampleCount, char* classes) const;
+    
+    /*
+     * Packs the networks and classifies all the samples, group by group and block by block.
+     */
+    void classify(const QList< Network* > &, const QList< InputSample* > &, QVector< char > &);
+    void classify(const QList< Network* > &, const TernarySampleSet &, QVector< char > &);
+    
+    /*
+     * The fraction of wrong answers of each network on the samples.
+     */
+    QVector< double > averageErrors(const QList< Network* > &, const QList< InputSample* > &);
+    QVector< double > averageErrors(const QList< Network* > &, const TernarySampleSet &);
+    
+    int networkCount() const;
+    
+private:
+    void packRecords(const QList< Network* > &, bool ternary);
+    
+    int m_groupSize;
+    int m_blockSize;
+    int m_count;
+    
+    QVector< int > m_hiddenCounts;        /* [network] */
+    QVector< PackedKernel > m_kernels;    /* [network] */
+    QVector< double > m_records;          /* [network][NetworkLayout::Size] */
+    QVector< double > m_ternaryRecords;   /* [network][TernaryNetworkLayout::Size] */
+};
+
+#endif
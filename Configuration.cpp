@@ -0,0 +1,165 @@
+#include "Configuration.h"
+#include "ProblemInfo.h"
+
+#include <QtGlobal>
+
+Configuration::Configuration()
+    : positiveEta(POSITIVE_ETA)
+    , negativeEta(NEGATIVE_ETA)
+    , maxStep(MAX_STEP)
+    , minStep(MIN_STEP)
+    , initialStep(INITIAL_STEP)
+    , hiddenSize(HIDDEN_SIZE)
+    , hiddenSizeMin(HIDDEN_SIZE_MIN)
+    , linkSizeMin(LINK_SIZE_MIN)
+    , populationSize(20)
+    , epochs(100)
+    , mutationsPerChild(10)
+    , generationTrainingSize(100)
+{}
+
+bool Configuration::isValid() const
+{
+    return positiveEta > 0 && negativeEta > 0 && minStep >= 0 && maxStep >= minStep && initialStep > 0
+           && hiddenSizeMin >= 1 && hiddenSizeMin <= hiddenSize && hiddenSize <= HIDDEN_SIZE_MAX
+           && linkSizeMin >= 0 && populationSize >= 2 && epochs >= 1 && mutationsPerChild >= 0
+           && generationTrainingSize >= 1;
+}
+
+QStringList Configuration::parameterNames()
+{
+    QStringList names;
+
+    names << "positiveEta" << "negativeEta" << "maxStep" << "minStep" << "initialStep"
+          << "hiddenSize" << "hiddenSizeMin" << "linkSizeMin"
+          << "populationSize" << "epochs" << "mutationsPerChild" << "generationTrainingSize";
+
+    return names;
+}
+
+bool Configuration::isIntegerParameter(const QString& name)
+{
+    return parameterNames().indexOf(name) >= parameterNames().indexOf("hiddenSize");
+}
+
+bool Configuration::setParameter(const QString& name, double value)
+{
+    int rounded = qRound(value);
+
+    if (name == "positiveEta") {
+        positiveEta = value;
+    } else if (name == "negativeEta") {
+        negativeEta = value;
+    } else if (name == "maxStep") {
+        maxStep = value;
+    } else if (name == "minStep") {
+        minStep = value;
+    } else if (name == "initialStep") {
+        initialStep = value;
+    } else if (name == "hiddenSize") {
+        hiddenSize = rounded;
+    } else if (name == "hiddenSizeMin") {
+        hiddenSizeMin = rounded;
+    } else if (name == "linkSizeMin") {
+        linkSizeMin = rounded;
+    } else if (name == "populationSize") {
+        populationSize = rounded;
+    } else if (name == "epochs") {
+        epochs = rounded;
+    } else if (name == "mutationsPerChild") {
+        mutationsPerChild = rounded;
+    } else if (name == "generationTrainingSize") {
+        generationTrainingSize = rounded;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+double Configuration::parameter(const QString& name) const
+{
+    if (name == "positiveEta") {
+        return positiveEta;
+    } else if (name == "negativeEta") {
+        return negativeEta;
+    } else if (name == "maxStep") {
+        return maxStep;
+    } else if (name == "minStep") {
+        return minStep;
+    } else if (name == "initialStep") {
+        return initialStep;
+    } else if (name == "hiddenSize") {
+        return hiddenSize;
+    } else if (name == "hiddenSizeMin") {
+        return hiddenSizeMin;
+    } else if (name == "linkSizeMin") {
+        return linkSizeMin;
+    } else if (name == "populationSize") {
+        return populationSize;
+    } else if (name == "epochs") {
+        return epochs;
+    } else if (name == "mutationsPerChild") {
+        return mutationsPerChild;
+    } else if (name == "generationTrainingSize") {
+        return generationTrainingSize;
+    }
+
+    return 0.0;
+}
+
+bool Configuration::parse(const QStringList& assignments)
+{
+    Q_FOREACH (const QString& assignment, assignments) {
+        QStringList pieces = assignment.split('=');
+        bool ok = (pieces.size() == 2);
+        double value = ok ? pieces[1].toDouble(&ok) : 0.0;
+
+        if (!ok || !setParameter(pieces[0].trimmed(), value)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * 15 digits are enough for the usual values, e.g. 10.2 stays 10.2; 17 are needed for some others.
+ */
+static QString formatParameter(double value)
+{
+    QString text = QString::number(value, 'g', 15);
+
+    if (text.toDouble() != value) {
+        text = QString::number(value, 'g', 17);
+    }
+
+    return text;
+}
+
+QString Configuration::toString() const
+{
+    QStringList assignments;
+
+    Q_FOREACH (const QString& name, parameterNames()) {
+        assignments << QString("%1=%2").arg(name).arg( formatParameter(parameter(name)) );
+    }
+
+    return assignments.join(" ");
+}
+
+struct DefaultConfiguration
+{
+    DefaultConfiguration()
+        : configuration(new Configuration)
+    {}
+
+    SharedConfiguration configuration;
+};
+
+Q_GLOBAL_STATIC(DefaultConfiguration, s_defaultConfiguration);
+
+SharedConfiguration defaultConfiguration()
+{
+    return s_defaultConfiguration()->configuration;
+}
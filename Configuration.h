@@ -0,0 +1,84 @@
+/*
+ * The parameters of the training that used to be fixed at compile time: the RPROP constants, the shape
+ * of new networks and the limits of the mutations, and the parameters of the genetic algorithm. The
+ * defaults are the macros in ProblemInfo.h and the values the training has always used.
+ *
+ * The sizes that fix the layout of the networks in memory (INPUT_SIZE, OUTPUT_SIZE, HIDDEN_SIZE_MAX) stay
+ * macros: they bound the hidden sizes here.
+ *
+ * Networks and ensembles share an immutable configuration through a SharedConfiguration, so any number
+ * of them, with different configurations, can be trained at the same time. Parameters can also be read
+ * and set by name, e.g. from the command line or by a sweep (see SweepRunner).
+ */
+
+#ifndef CONFIGURATION_H
+#define CONFIGURATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QSharedPointer>
+
+class Configuration
+{
+public:
+    explicit Configuration();
+
+    /*
+     * RPROP constants (see Network::updateByRProp()); new links start with the initial step.
+     */
+    double positiveEta;
+    double negativeEta;
+    double maxStep;
+    double minStep;
+    double initialStep;
+
+    /*
+     * Hidden neurons of a new network, and the fewest a mutation can leave; the fewest links a link
+     * removal can leave.
+     */
+    int hiddenSize;
+    int hiddenSizeMin;
+    int linkSizeMin;
+
+    /*
+     * The genetic algorithm: networks in the population, epochs of training(), mutations applied to each
+     * child, and samples each network is trained on with RPROP at every epoch.
+     */
+    int populationSize;
+    int epochs;
+    int mutationsPerChild;
+    int generationTrainingSize;
+
+    /*
+     * Whether the parameters are in range: the hidden sizes between 1 and HIDDEN_SIZE_MAX, and so on.
+     */
+    bool isValid() const;
+
+    /*
+     * Parameters by name (the names of the fields above); integer parameters are rounded. Return false
+     * for an unknown name.
+     */
+    static QStringList parameterNames();
+    static bool isIntegerParameter(const QString &);
+    bool setParameter(const QString &, double);
+    double parameter(const QString &) const;
+
+    /*
+     * Sets parameters from "name=value" strings; returns false at the first one that can't be parsed.
+     */
+    bool parse(const QStringList &);
+
+    /*
+     * All the parameters as "name=value", separated by spaces; parse() gives them back exactly.
+     */
+    QString toString() const;
+};
+
+typedef QSharedPointer< const Configuration > SharedConfiguration;
+
+/*
+ * The default configuration, shared by the networks created without one.
+ */
+SharedConfiguration defaultConfiguration();
+
+#endif
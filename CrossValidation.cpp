@@ -0,0 +1,233 @@
+#include "CrossValidation.h"
+#include "Ensemble.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+class FoldRunnerThread : public QThread
+{
+public:
+    FoldRunnerThread(CrossValidation* validation, int runner, int workers)
+        : m_validation(validation)
+        , m_runner(runner)
+        , m_workers(workers)
+    {}
+
+protected:
+    virtual void run()
+    {
+        if (TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->setThreadName(QString("fold runner %1").arg(m_runner));
+        }
+
+        m_validation->runFolds(m_workers);
+    }
+
+private:
+    CrossValidation* m_validation;
+    int m_runner;
+    int m_workers;
+};
+
+static bool foldOrder(const CrossValidation::FoldResult& r1, const CrossValidation::FoldResult& r2)
+{
+    return (r1.repeat != r2.repeat) ? (r1.repeat < r2.repeat) : (r1.fold < r2.fold);
+}
+
+CrossValidation::CrossValidation(const QList< InputSample* >& samples, int folds, int repeats, int threads)
+    : m_samples(samples)
+    , m_folds( qMax(folds, 3) )
+    , m_repeats( qMax(repeats, 1) )
+    , m_threads( qMax(threads, 1) )
+{}
+
+CrossValidation::~CrossValidation()
+{}
+
+bool CrossValidation::setConfiguration(const Configuration& config)
+{
+    if (!config.isValid()) {
+        return false;
+    }
+
+    m_configuration = config;
+    return true;
+}
+
+bool CrossValidation::setNetworks(int networks)
+{
+    Configuration config = m_configuration;
+    config.populationSize = networks;
+
+    return setConfiguration(config);
+}
+
+bool CrossValidation::setEpochs(int epochs)
+{
+    Configuration config = m_configuration;
+    config.epochs = epochs;
+
+    return setConfiguration(config);
+}
+
+/*
+ * The budget is split among as many runners as there are folds, at most one per thread; the first
+ * runners take the threads left over by the division.
+ */
+CrossValidation::Summary CrossValidation::run()
+{
+    TRACE_SPAN("cross-validation", "training");
+
+    shuffle();
+    m_results.clear();
+    m_nextFold = 0;
+
+    int runners = qMin(m_threads, m_folds * m_repeats);
+    QList< FoldRunnerThread* > threads;
+
+    for (int i = 0; i < runners; i++) {
+        int workers = m_threads / runners + ((i < m_threads % runners) ? 1 : 0);
+
+        threads.append( new FoldRunnerThread(this, i, workers) );
+        threads.last()->start();
+    }
+
+    Q_FOREACH (FoldRunnerThread* thread, threads) {
+        thread->wait();
+    }
+
+    qDeleteAll(threads);
+    qSort(m_results.begin(), m_results.end(), foldOrder);
+
+    Summary summary = summarize();
+
+    cout << ":: Cross-validation over " << summary.folds << " folds: accuracy " << summary.meanAccuracy
+         << " +- " << summary.accuracyDeviation << ", front size " << summary.meanFrontSize
+         << " +- " << summary.frontSizeDeviation << endl;
+
+    return summary;
+}
+
+QList< CrossValidation::FoldResult > CrossValidation::results() const
+{
+    QMutexLocker locker(&m_resultsLock);
+    return m_results;
+}
+
+void CrossValidation::runFolds(int workers)
+{
+    while (true) {
+        int task = m_nextFold.fetchAndAddRelaxed(1);
+
+        if (task >= m_folds * m_repeats) {
+            break;
+        }
+
+        FoldResult result = runFold(task / m_folds, task % m_folds, workers);
+
+        QMutexLocker locker(&m_resultsLock);
+        m_results.append(result);
+    }
+}
+
+CrossValidation::FoldResult CrossValidation::runFold(int repeat, int fold, int workers)
+{
+    TRACE_SPAN_ARG("fold", "training", repeat * m_folds + fold);
+
+    int measuringFold = (fold + 1) % m_folds;
+
+    QList< InputSample* > test = foldSamples(repeat, fold);
+    QList< InputSample* > measuring = foldSamples(repeat, measuringFold);
+    QList< InputSample* > training;
+
+    for (int f = 0; f < m_folds; f++) {
+        if (f != fold && f != measuringFold) {
+            training += foldSamples(repeat, f);
+        }
+    }
+
+    NetworkEnsemble ensemble(m_configuration, workers);
+    ensemble.training(training, measuring);
+
+    FoldResult result;
+    result.repeat = repeat;
+    result.fold = fold;
+    result.accuracy = ensemble.test(test);
+
+    QList< Network* > front = ensemble.takeNetworks();
+    result.frontSize = front.size();
+    qDeleteAll(front);
+
+    return result;
+}
+
+void CrossValidation::shuffle()
+{
+    m_shuffles.clear();
+
+    for (int r = 0; r < m_repeats; r++) {
+        QList< InputSample* > shuffled = m_samples;
+
+        for (int i = shuffled.size() - 1; i > 0; i--) {
+            shuffled.swap( i, randomInteger(0, i + 1) );
+        }
+
+        m_shuffles.append(shuffled);
+    }
+}
+
+QList< InputSample* > CrossValidation::foldSamples(int repeat, int fold) const
+{
+    const QList< InputSample* >& shuffled = m_shuffles[repeat];
+
+    int begin = (shuffled.size() * fold) / m_folds;
+    int end = (shuffled.size() * (fold + 1)) / m_folds;
+
+    return shuffled.mid(begin, end - begin);
+}
+
+/*
+ * Standard deviations are those of the sample, over the folds.
+ */
+CrossValidation::Summary CrossValidation::summarize() const
+{
+    Summary summary;
+    summary.folds = m_results.size();
+    summary.meanAccuracy = 0;
+    summary.accuracyDeviation = 0;
+    summary.meanFrontSize = 0;
+    summary.frontSizeDeviation = 0;
+
+    if (m_results.isEmpty()) {
+        return summary;
+    }
+
+    Q_FOREACH (const FoldResult& result, m_results) {
+        summary.meanAccuracy += result.accuracy;
+        summary.meanFrontSize += result.frontSize;
+    }
+
+    summary.meanAccuracy /= m_results.size();
+    summary.meanFrontSize /= m_results.size();
+
+    if (m_results.size() < 2) {
+        return summary;
+    }
+
+    Q_FOREACH (const FoldResult& result, m_results) {
+        summary.accuracyDeviation += pow(result.accuracy - summary.meanAccuracy, 2);
+        summary.frontSizeDeviation += pow(result.frontSize - summary.meanFrontSize, 2);
+    }
+
+    summary.accuracyDeviation = sqrt( summary.accuracyDeviation / (m_results.size() - 1) );
+    summary.frontSizeDeviation = sqrt( summary.frontSizeDeviation / (m_results.size() - 1) );
+
+    return summary;
+}
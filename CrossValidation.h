@@ -0,0 +1,103 @@
+/*
+ * k-fold cross-validation in one process, optionally repeated with different shuffles. The samples are
+ * shuffled once per repetition and cut into k folds; every fold is the test set of one ensemble, the next
+ * fold (cyclically) measures its networks during the training, as the generation test does, and the
+ * others train them. The folds are lists of pointers into the sample set, which is never copied.
+ *
+ * The ensembles of all the folds share a thread budget: as many of them as the budget allows train at the
+ * same time, each in its own thread with an equal share of the workers, and a thread that is done with a
+ * fold takes the next one. The results are the test accuracy and the size of the front of every fold,
+ * with their mean and standard deviation.
+ */
+
+#ifndef CROSSVALIDATION_H
+#define CROSSVALIDATION_H
+
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "ProblemInfo.h"
+#include "Configuration.h"
+
+class CrossValidation
+{
+    Q_DISABLE_COPY(CrossValidation)
+
+public:
+    struct FoldResult {
+        int repeat;
+        int fold;
+        double accuracy; /* fraction of right answers on the fold */
+        int frontSize;
+    };
+
+    struct Summary {
+        int folds;       /* folds run, over all the repetitions */
+        double meanAccuracy;
+        double accuracyDeviation;
+        double meanFrontSize;
+        double frontSizeDeviation;
+    };
+
+    /*
+     * The samples are only read; at least 3 folds are needed, for training, measuring and testing.
+     */
+    explicit CrossValidation(const QList< InputSample* >& samples, int folds = 5, int repeats = 1,
+                             int threads = QThread::idealThreadCount());
+    virtual ~CrossValidation();
+
+    /*
+     * How the ensembles are trained; setNetworks() and setEpochs() change the population size and the
+     * epochs of the configuration. They return false, leaving the configuration as it was, if the new
+     * one isn't valid.
+     */
+    bool setConfiguration(const Configuration &);
+    bool setNetworks(int);
+    bool setEpochs(int);
+
+    /*
+     * Trains and tests an ensemble on every fold of every repetition, and prints the summary.
+     */
+    Summary run();
+
+    /*
+     * The results of the last run, ordered by repetition and fold.
+     */
+    QList< FoldResult > results() const;
+
+    /*
+     * Draws a new order of the samples for every repetition; run() starts with it. A fold of a repetition
+     * is a slice of its order, as a list of pointers into the samples: the folds hold every sample once,
+     * and their sizes differ by one at most.
+     */
+    void shuffle();
+    QList< InputSample* > foldSamples(int repeat, int fold) const;
+
+private:
+    friend class FoldRunnerThread;
+
+    /*
+     * Takes folds until there are none left, training each with the given number of workers.
+     */
+    void runFolds(int workers);
+    FoldResult runFold(int repeat, int fold, int workers);
+
+    Summary summarize() const;
+
+    QList< InputSample* > m_samples;
+    int m_folds;
+    int m_repeats;
+    int m_threads;
+    Configuration m_configuration;
+
+    QVector< QList< InputSample* > > m_shuffles; /* one order of the samples per repetition */
+    QAtomicInt m_nextFold;
+
+    mutable QMutex m_resultsLock;
+    QList< FoldResult > m_results;
+};
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * A network flattened into fixed-size arrays, for the evaluation kernels that don't need to walk
+ * neurons and links. Hidden neurons are numbered in the order of the hidden layer, and missing links
+ * have weight 0.
+ * 
+ * Input neurons compute sigmoid(x * inputWeights[i] + inputBias[i]), mirroring what happens in
+ * Network::applyInput() (see the note in Network::predictOutput()).
+ */
+
+#ifndef DENSENETWORK_H
+#define DENSENETWORK_H
+
+#include "ProblemInfo.h"
+
+struct DenseNetwork
+{
+    int hiddenCount;
+    
+    double inputWeights[INPUT_SIZE];
+    double inputBias[INPUT_SIZE];
+    
+    double hiddenWeights[HIDDEN_SIZE_MAX][INPUT_SIZE];
+    double hiddenBias[HIDDEN_SIZE_MAX];
+    
+    double outputWeights[HIDDEN_SIZE_MAX];
+    double outputBias;
+};
+
+#endif
@@ -3,21 +3,201 @@
  */
 
 #include <Ensemble.h>
+#include <EnsembleExporter.h>
+#include <Instrumentation.h>
+#include <Tracing.h>
 #include <QDebug>
+#include <QFile>
+#include <QDataStream>
 
 #include <iostream>
 
 using namespace std;
 
+#define SAVED_ENSEMBLE_MAGIC   0x4e455345 /* "NESE" */
+#define SAVED_ENSEMBLE_VERSION 1
+
+/*
+ * Trains a network with RPROP on a list of samples.
+ */
+class RpropTask : public Task
+{
+public:
+    RpropTask(Network* net, const QList< InputSample* >& samples)
+        : m_net(net)
+        , m_samples(samples)
+    {}
+    
+    virtual void run()
+    {
+        TRACE_SPAN_ARG("rprop", "network", m_net->id());
+        int iteration = 1;
+        
+        Q_FOREACH (InputSample* sample, m_samples) {
+            m_net->applyInput(sample->attributes, sample->n_class);
+            
+            /*
+             * At the first iteration the "previous gradient" isn't defined so we skip rprop in that case
+             */
+            if (iteration > 1) {
+                m_net->updateByRProp();
+            }
+            
+            iteration++;
+        }
+    }
+    
+private:
+    Network* m_net;
+    QList< InputSample* > m_samples;
+};
+
+/*
+ * Creates a mutated copy of a network, and stores it in a given position of the children list.
+ */
+class BreedTask : public Task
+{
+public:
+    BreedTask(const Network* parent, int id, Network** child)
+        : m_parent(parent)
+        , m_id(id)
+        , m_child(child)
+    {}
+    
+    virtual void run()
+    {
+        TRACE_SPAN_ARG("mutate", "network", m_id);
+        Network* child = new Network(m_parent, m_id);
+        
+        for (int i = 1; i <= child->configuration().mutationsPerChild; i++) {
+            MutationOperator mutation = (MutationOperator)(randomInteger(1, 5));
+            child->mutate(mutation);
+        }
+        
+        *m_child = child;
+    }
+    
+private:
+    const Network* m_parent;
+    int m_id;
+    Network** m_child;
+};
+
+/*
+ * Where the tasks of the pipelined training leave the children they are done with.
+ */
+class ChildQueue
+{
+public:
+    void push(Network* child)
+    {
+        QMutexLocker locker(&m_lock);
+        m_children.append(child);
+        m_childReady.wakeOne();
+    }
+    
+    /*
+     * Blocks until a child is available.
+     */
+    Network* pop()
+    {
+        QMutexLocker locker(&m_lock);
+        
+        while (m_children.isEmpty()) {
+            m_childReady.wait(&m_lock);
+        }
+        
+        return m_children.takeFirst();
+    }
+    
+private:
+    QMutex m_lock;
+    QWaitCondition m_childReady;
+    QList< Network* > m_children;
+};
+
+/*
+ * Mutates a freshly cloned network, trains it with RPROP and measures its average error, then hands it
+ * back through the queue.
+ */
+class ChildTask : public Task
+{
+public:
+    ChildTask(Network* child, const QList< InputSample* >& training, const QList< InputSample* >& test,
+              ChildQueue* queue)
+        : m_child(child)
+        , m_training(training)
+        , m_test(test)
+        , m_queue(queue)
+    {}
+    
+    virtual void run()
+    {
+        TRACE_SPAN_ARG("child", "network", m_child->id());
+        
+        for (int i = 1; i <= m_child->configuration().mutationsPerChild; i++) {
+            MutationOperator mutation = (MutationOperator)(randomInteger(1, 5));
+            m_child->mutate(mutation);
+        }
+        
+        RpropTask(m_child, m_training).run();
+        
+        QList< Network* > single;
+        single.append(m_child);
+        
+        BatchEvaluator evaluator(1);
+        m_child->setAverageError( evaluator.averageErrors(single, m_test).first() );
+        
+        m_queue->push(m_child);
+    }
+    
+private:
+    Network* m_child;
+    QList< InputSample* > m_training;
+    QList< InputSample* > m_test;
+    ChildQueue* m_queue;
+};
+
 /*
  * Creates the required amount of networks
  */
-NetworkEnsemble::NetworkEnsemble(int numNetworks)
+NetworkEnsemble::NetworkEnsemble(int numNetworks, int threads, bool pinThreads)
+    : m_config( defaultConfiguration() )
+    , m_runtime(threads, pinThreads)
+    , m_scheduler(&m_runtime)
+    , m_archiveSize(0)
+    , m_epoch(0)
+    , m_ternaryEncoding(false)
+    , m_bestHypervolume(-1)
+{
+    createNetworks(numNetworks);
+}
+
+NetworkEnsemble::NetworkEnsemble(const Configuration& config, int threads, bool pinThreads)
+    : m_config( new Configuration(config) )
+    , m_runtime(threads, pinThreads)
+    , m_scheduler(&m_runtime)
+    , m_archiveSize(0)
+    , m_epoch(0)
+    , m_ternaryEncoding(false)
+    , m_bestHypervolume(-1)
+{
+    Q_ASSERT (config.isValid());
+    
+    createNetworks(m_config->populationSize);
+}
+
+const Configuration& NetworkEnsemble::configuration() const
+{
+    return *m_config;
+}
+
+void NetworkEnsemble::createNetworks(int numNetworks)
 {
     int i = 1;
     
     for (; i <= numNetworks; i++) {
-        Network* network = new Network(i);
+        Network* network = new Network(i, m_config);
         m_networks.append(network);
     }
     
@@ -30,275 +210,605 @@ NetworkEnsemble::NetworkEnsemble(int numNetworks)
 NetworkEnsemble::~NetworkEnsemble()
 {
     qDeleteAll(m_networks);
+    qDeleteAll(m_population);
+    qDeleteAll(m_bestFront);
 }
 
 void NetworkEnsemble::training(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest)
 {
-    QList< Network* > archive;
-    QList< Network* > population( m_networks );
+    TrainingBudget budget(m_config->epochs);
+    training(trainingSamples, generationTest, budget);
+}
+
+/*
+ * Every network in the population is evaluated once per epoch, the children of the last epoch included.
+ */
+void NetworkEnsemble::training(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest,
+                               TrainingBudget& budget)
+{
+    beginTraining(trainingSamples, generationTest);
+    budget.start();
     
-    int desiredPopulationSize = population.size();
-    int desiredArchiveSize = desiredPopulationSize / 2;
+    bool running = true;
     
-    QList< InputSample* > generationTraining = trainingSamples.mid(0, 100);
-
-    for (int epoch = 1; epoch <= 100; epoch++) {
-        int iteration = 1;
+    while (running) {
+        int evaluations = m_population.size();
         
-        cout << ":: Epoch " << epoch << " running." << endl;
+        trainEpoch();
+        running = budget.recordEpoch(evaluations, m_archive.hypervolume());
+    }
+    
+    cout << ":: Training stopped after " << budget.epochs() << " epochs: "
+         << TrainingBudget::stopReasonName( budget.stopReason() ) << "." << endl;
+    
+    endTraining();
+}
+
+void NetworkEnsemble::beginTraining(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest)
+{
+    m_archive.clear();
+    m_population = m_networks;
+    m_networks.clear();
+    
+    m_archiveSize = m_population.size() / 2;
+    m_epoch = 0;
+    
+    replaceSamples(trainingSamples, generationTest);
+    
+    QMutexLocker locker(&m_bestFrontLock);
+    
+    qDeleteAll(m_bestFront);
+    m_bestFront.clear();
+}
+
+void NetworkEnsemble::replaceSamples(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest)
+{
+    m_generationTraining = trainingSamples.mid(0, m_config->generationTrainingSize);
+    m_generationTest = generationTest;
+    
+    m_ternaryTest.clear();
+    
+    if (m_ternaryEncoding && !m_ternaryTest.encode(m_generationTest)) {
+        cout << ":: The samples aren't ternary, they won't be packed." << endl;
+    }
+    
+    /*
+     * Hypervolumes measured on other samples can't be compared; the copies stay until the next epoch.
+     */
+    QMutexLocker locker(&m_bestFrontLock);
+    m_bestHypervolume = -1;
+}
+
+void NetworkEnsemble::trainEpoch()
+{
+    int epoch = ++m_epoch;
+    
+    cout << ":: Epoch " << epoch << " running." << endl;
+    INSTRUMENT_BEGIN_EPOCH(epoch);
+    TRACE_SPAN_ARG("epoch", "training", epoch);
+    
+    /*
+     * Life-long training using rprop; networks are independent, so each one is trained by its own task.
+     */
+    {
+        INSTRUMENT_PHASE(RpropPhase);
+        TRACE_SPAN("rprop", "training");
+        TaskGroup group;
         
-        /*
-         * Life-long training using rprop
-         */
-        Q_FOREACH (InputSample* sample, generationTraining) {
-            
-            Q_FOREACH (Network* net, population) {
-                net->applyInput(sample->attributes, sample->n_class);
-                
-                /*
-                 * At the first iteration the "previous gradient" isn't defined so we skip rprop in that case
-                 */
-                if (iteration > 1) {
-                    net->updateByRProp();
-                }
-            }
-            iteration++;
+        Q_FOREACH (Network* net, m_population) {
+            m_runtime.submit(new RpropTask(net, m_generationTraining), &group);
         }
         
-        /*
-         * Compute the new average errors, to be used as an objective function to minimize in the genetic algorithm.
-         */
-        Q_FOREACH (Network* net, population) {
-            net->setAverageError( computeAverageError(net, generationTest) );
+        m_runtime.wait(&group);
+    }
+    
+    /*
+     * Compute the new average errors, to be used as an objective function to minimize in the genetic algorithm.
+     */
+    {
+        INSTRUMENT_PHASE(FitnessPhase);
+        TRACE_SPAN("fitness", "training");
+        
+        if (m_ternaryTest.isEmpty()) {
+            computeAverageErrors(m_population, m_generationTest);
+        } else {
+            computeAverageErrors(m_population, m_ternaryTest);
         }
+    }
 
-        QMap< int, QList< Network* > > ranks = computeParetoFrontRank(population);
-        QList< Network* > rest;
-        archive.clear();
-        
-        /*
-         * Everything that doesn't go into the archive is added to the "rest" list, to be deallocated later.
-         */
-        for (QMap< int, QList< Network* > >::iterator it = ranks.begin(); it != ranks.end(); it++) {
-            QList< Network* > currentFront = it.value();
+    /*
+     * The archive is kept across epochs: the children are inserted, and the survivors only move if
+     * their error has changed with the last training.
+     */
+    {
+        INSTRUMENT_PHASE(RankingPhase);
+        TRACE_SPAN("ranking", "training");
         
-            if (archive.size() == desiredArchiveSize) {
-                rest += currentFront;
-                continue;
-            }
-            
-            if (archive.size() + currentFront.size() > desiredArchiveSize) {
-                int remainingSpace = archive.size() + currentFront.size() - desiredArchiveSize;
-                
-                QList< Network* > sorted = sortBySparsity(currentFront);
-                archive += sorted.mid(remainingSpace + 1); /* takes the sparsest ones */
-                rest = sorted.mid(0, remainingSpace);
+        Q_FOREACH (Network* net, m_population) {
+            if (m_archive.contains(net)) {
+                m_archive.update(net);
             } else {
-                archive += currentFront;
+                m_archive.insert(net);
             }
         }
+    }
+    
+    /*
+     * Everything that doesn't stay in the archive is added to the "rest" list, to be deallocated later.
+     */
+    QList< Network* > rest;
+    
+    {
+        INSTRUMENT_PHASE(SparsityPhase);
+        TRACE_SPAN("sparsity", "training");
+        
+        rest = m_archive.truncate(m_archiveSize);
+    }
+    
+    {
+        INSTRUMENT_PHASE(DeallocationPhase);
+        TRACE_SPAN("deallocation", "training");
         
         qDeleteAll(rest);
         rest.clear();
+    }
+    
+    keepBestFront();
+    
+    QList< Network* > survivors = m_archive.networks();
+    
+    m_population = breed(survivors);
+    m_population += survivors;
+    
+    INSTRUMENT_FOOTPRINT( populationFootprint(m_population) );
+    INSTRUMENT_END_EPOCH();
+}
+
+/*
+ * The children of the last epoch haven't been evaluated yet, so the ensemble is the first front of the
+ * archive, or the copies of the best front if it had a larger hypervolume (the training may have stopped
+ * after the front got worse); everything else is deallocated.
+ */
+void NetworkEnsemble::endTraining()
+{
+    {
+        QMutexLocker locker(&m_bestFrontLock);
         
-        population = breed(archive);
-        population += archive;
+        if (!m_bestFront.isEmpty() && m_bestHypervolume > m_archive.hypervolume()) {
+            Q_FOREACH (const Network* net, m_bestFront) {
+                m_networks.append( new Network(net, net->id()) );
+            }
+        } else {
+            m_networks = m_archive.front(0);
+        }
     }
+    
+    m_archive.clear();
+    
+    Q_FOREACH (Network* net, m_population) {
+        if (!m_networks.contains(net)) {
+            delete net;
+        }
+    }
+    
+    m_population.clear();
+}
 
-    m_networks = paretoFront(population);
+int NetworkEnsemble::epoch() const
+{
+    return m_epoch;
 }
 
-double NetworkEnsemble::computeAverageError(Network* net, const QList< InputSample* >& set)
+void NetworkEnsemble::setTernaryEncoding(bool enabled)
 {
-    double percentageError = 0.0;
-    int wrong = 0;
+    m_ternaryEncoding = enabled;
+}
+
+bool NetworkEnsemble::ternaryEncoding() const
+{
+    return m_ternaryEncoding;
+}
+
+QList< Network* > NetworkEnsemble::currentFront() const
+{
+    QMutexLocker locker(&m_bestFrontLock);
+    QList< Network* > front;
     
-    Q_FOREACH (InputSample* sample, set) {
-        net->applyInput(sample->attributes, sample->n_class);
-        
-        if (net->output() != sample->n_class) {
-            wrong++;
-        }
+    Q_FOREACH (const Network* net, m_bestFront) {
+        front.append( new Network(net, net->id()) );
     }
     
-    percentageError = (double)wrong / (double)set.size();
-    return percentageError;
+    return front;
 }
 
-double NetworkEnsemble::test(QList< InputSample* >& testSamples)
-{    
-    int right = 0;
-    int wrong = 0;
-    /*
-     * The total answer is the answer given by the maximum number of networks in the Pareto front.
-     */
-    for (QList< InputSample* >::iterator sample = testSamples.begin(); sample != testSamples.end(); sample++) {        
-        int answers[NUM_CLASSES];
+/*
+ * The errors of all the fronts were measured on the same samples, so their hypervolumes can be compared.
+ * The copies are made outside of the lock, so readers only wait for the swap.
+ */
+void NetworkEnsemble::keepBestFront()
+{
+    double hypervolume = m_archive.hypervolume();
+    
+    if (hypervolume <= m_bestHypervolume) {
+        return;
+    }
+    
+    QList< Network* > front;
+    
+    Q_FOREACH (const Network* net, m_archive.front(0)) {
+        front.append( new Network(net, net->id()) );
+    }
+    
+    {
+        QMutexLocker locker(&m_bestFrontLock);
         
-        for (int i = 0; i < NUM_CLASSES; i++) {
-            answers[i] = 0;
-        }
+        qSwap(front, m_bestFront);
+        m_bestHypervolume = hypervolume;
+    }
+    
+    qDeleteAll(front);
+}
 
-        for (QList< Network* >::iterator it = m_networks.begin(); it != m_networks.end(); it++) {
-            (*it)->applyInput((*sample)->attributes, (*sample)->n_class);
-            int output = (*it)->output();
-                        
-            answers[output]++;
-        }
-        
-        int max = 0;
-        unsigned int maxClass = 0;
-        
-        for (int i = 0; i < NUM_CLASSES; i++) {
-            if (answers[i] > max) {
-                max = answers[i];
-                maxClass = i;
-            }
-        }
-        
-        if (maxClass == (*sample)->n_class) {
-            right++;
-        } else {
-            wrong++;
-        }
+/*
+ * Networks spread evenly along the first front of the archive, from the simplest to the most accurate.
+ */
+QList< Network* > NetworkEnsemble::emigrants(int count) const
+{
+    QList< Network* > front = m_archive.front(0);
+    QList< Network* > chosen;
+    
+    if (front.size() <= count) {
+        return front;
     }
     
-    cout << ":: Test results: " << right << " right answers and " << wrong << " wrong ones " << endl;
+    for (int i = 0; i < count; i++) {
+        int position = (count == 1) ? 0 : i * (front.size() - 1) / (count - 1);
+        chosen.append( front[position] );
+    }
     
-    double rightPercentage = (double)right / (double)testSamples.size();
-    return rightPercentage;
+    return chosen;
+}
+
+void NetworkEnsemble::immigrate(Network* net)
+{
+    net->setId(m_nextId++);
+    net->setConfiguration(m_config);
+    m_population.append(net);
+}
+
+void NetworkEnsemble::setNetworks(const QList< Network* >& networks)
+{
+    qDeleteAll(m_networks);
+    m_networks = networks;
+}
+
+QList< Network* > NetworkEnsemble::takeNetworks()
+{
+    QList< Network* > networks = m_networks;
+    m_networks.clear();
+    
+    return networks;
+}
+
+EnsembleCompactor::Report NetworkEnsemble::compact(const QList< InputSample* >& heldOut)
+{
+    TRACE_SPAN("compaction", "inference");
+    
+    EnsembleCompactor compactor(heldOut);
+    m_networks = compactor.compact(m_networks);
+    
+    EnsembleCompactor::Report report = compactor.report();
+    
+    cout << ":: Compaction: " << report.networksBefore << " networks with " << report.linksBefore << " links to "
+         << report.networksAfter << " with " << report.linksAfter << " (" << report.merged << " merged, "
+         << report.dropped << " dropped)" << endl;
+    
+    return report;
+}
+
+Network* NetworkEnsemble::distill(const QList< InputSample* >& training, const QList< InputSample* >& evaluation,
+                                  int syntheticSamples)
+{
+    EnsembleDistiller distiller(m_networks);
+    distiller.setSyntheticSamples(syntheticSamples);
+    
+    Network* student = distiller.distill(training, evaluation, m_nextId++);
+    EnsembleDistiller::Report report = distiller.report();
+    
+    cout << ":: Distillation: " << report.agreement * 100.0 << "% agreement with the ensemble, "
+         << report.studentLinks << " links instead of " << report.ensembleLinks << ", "
+         << report.speedup << " times faster" << endl;
+    
+    return student;
 }
 
 /*
- * The new population is generated by the previous one
+ * A header, the number of networks, then the genome of each network (see Network::save()).
  */
-QList< Network* > NetworkEnsemble::breed(QList< Network* > parents)
+bool NetworkEnsemble::saveNetworks(const QString& path) const
 {
-    QList< Network* > children;
+    QFile file(path);
     
-    Q_FOREACH (Network* parent, parents) {
-        Network* child = new Network(parent, m_nextId++);
-        
-        for (int i = 1; i <= 10; i++) {
-            MutationOperator mutation = (MutationOperator)(randomInteger(1, 5));
-            child->mutate(mutation);
-        }
-        
-        children.append(child);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
     }
     
-    return children;
+    QDataStream stream(&file);
+    stream << (quint32)SAVED_ENSEMBLE_MAGIC << (quint32)SAVED_ENSEMBLE_VERSION << (qint32)m_networks.size();
+    
+    Q_FOREACH (const Network* net, m_networks) {
+        net->save(stream);
+    }
+    
+    file.close();
+    return stream.status() == QDataStream::Ok;
 }
 
-QMap< int, QList< Network*> > NetworkEnsemble::computeParetoFrontRank(QList< Network* > population)
+bool NetworkEnsemble::loadNetworks(const QString& path, int populationSize)
 {
-    QList< Network* > currentPopulation( population );
-    QMap< int, QList< Network* > > rankList;
+    QFile file(path);
     
-    int i = 1;
-    while ( !currentPopulation.isEmpty() ) {
-        rankList.insert(i, paretoFront(currentPopulation));
-
-        Q_FOREACH (Network* net, rankList[i]) {
-            for (QList< Network* >::iterator it = currentPopulation.begin(); it < currentPopulation.end(); it++) {
-                
-                if ((*it)->id() == net->id()) {
-                    currentPopulation.erase(it);
-                }
-            }
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    qint32 count;
+    
+    stream >> magic >> version >> count;
+    
+    if (stream.status() != QDataStream::Ok || magic != SAVED_ENSEMBLE_MAGIC
+        || version != SAVED_ENSEMBLE_VERSION || count < 1) {
+        return false;
+    }
+    
+    QList< Network* > saved;
+    
+    for (int i = 0; i < count; i++) {
+        Network* net = Network::load(stream, m_nextId + i, m_config);
+        
+        if (!net) {
+            qDeleteAll(saved);
+            return false;
         }
-
-        i++;
+        
+        net->setVoteWeight(1);
+        saved.append(net);
+    }
+    
+    m_nextId += count;
+    
+    /*
+     * The whole file is read, so that a corrupt one is never half loaded, but the population keeps the
+     * requested size.
+     */
+    while (saved.size() > qMax(populationSize, 1)) {
+        delete saved.takeLast();
+    }
+    
+    /*
+     * The saved networks are cloned in turn, so they all get about the same number of children.
+     */
+    QList< Network* > parents;
+    
+    for (int i = saved.size(); i < populationSize; i++) {
+        parents.append( saved[ (i - saved.size()) % saved.size() ] );
     }
     
-    return rankList;
+    setNetworks( saved + breed(parents) );
+    
+    cout << ":: Loaded " << saved.size() << " of the " << count << " networks in " << path.toStdString() << ", "
+         << m_networks.size() - saved.size() << " clones added." << endl;
+    
+    return true;
 }
 
-QList< Network* > NetworkEnsemble::paretoFront(QList< Network* >& population)
+bool NetworkEnsemble::exportHeader(const QString& path, const QString& name) const
 {
-    QList< Network* > front;
+    return EnsembleExporter(name).writeHeader(m_networks, path);
+}
+
+/*
+ * Steady-state version of training(). After the first population has been trained and evaluated, every
+ * child is cloned here, then mutated, trained and evaluated by a task while the next ones are being
+ * cloned; each child joins the population as soon as its task is done, and pushes out the worst network
+ * (last rank, most crowded). There is no barrier between generations, so the workers never wait for the
+ * slowest child of an epoch.
+ * 
+ * The networks are trained only once, as children: the ones in the population are the parents of the
+ * children in flight, so they must not change. The same number of children is bred as by training().
+ */
+void NetworkEnsemble::pipelinedTraining(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest)
+{
+    QList< Network* > population( m_networks );
+    QList< InputSample* > generationTraining = trainingSamples.mid(0, m_config->generationTrainingSize);
+    
+    int desiredPopulationSize = population.size();
+    int childrenPerGeneration = qMax(1, desiredPopulationSize / 2);
+    int totalChildren = m_config->epochs * childrenPerGeneration;
+    int window = 2 * m_runtime.workerCount(); /* children in flight */
+    
+    {
+        TRACE_SPAN("rprop", "training");
+        TaskGroup group;
+        
+        Q_FOREACH (Network* net, population) {
+            m_runtime.submit(new RpropTask(net, generationTraining), &group);
+        }
+        
+        m_runtime.wait(&group);
+        computeAverageErrors(population, generationTest);
+    }
+    
+    ParetoArchive archive;
     
     Q_FOREACH (Network* net, population) {
-        bool paretoDominator = true;
+        archive.insert(net);
+    }
+    
+    ChildQueue queue;
+    TaskGroup children;
+    int submitted = 0;
+    int received = 0;
+    int nextParent = 0;
+    
+    while (received < totalChildren) {
+        
+        if (received % childrenPerGeneration == 0) {
+            int generation = received / childrenPerGeneration + 1;
+            
+            cout << ":: Generation " << generation << " running." << endl;
+            INSTRUMENT_BEGIN_EPOCH(generation);
+        }
         
-        for (QList< Network* >::iterator it = front.begin(); it < front.end(); it++) {
-            if (paretoDominates(net, (*it))) {
-                front.erase(it);
-            } else if (paretoDominates((*it), net)) {
-                paretoDominator = false;
-                break;
+        /*
+         * Parents are taken in turn, as breed() gives one child to each of them.
+         */
+        {
+            INSTRUMENT_PHASE(BreedingPhase);
+            
+            while (submitted < totalChildren && submitted - received < window) {
+                Network* parent = population[nextParent++ % population.size()];
+                Network* child = new Network(parent, m_nextId++);
+                
+                m_runtime.submit(new ChildTask(child, generationTraining, generationTest, &queue), &children);
+                submitted++;
             }
         }
         
-        if (paretoDominator) {
-            front.append(net);
+        Network* child = queue.pop();
+        received++;
+        
+        archive.insert(child);
+        population.append(child);
+        
+        if (archive.size() > desiredPopulationSize) {
+            Network* worst = archive.takeWorst();
+            population.removeOne(worst);
+            
+            INSTRUMENT_PHASE(DeallocationPhase);
+            delete worst;
+        }
+        
+        if (received % childrenPerGeneration == 0) {
+            INSTRUMENT_FOOTPRINT( populationFootprint(population) );
+            INSTRUMENT_END_EPOCH();
         }
     }
     
-    return front;
+    m_runtime.wait(&children);
+    
+    m_networks = archive.front(0);
+    
+    Q_FOREACH (Network* net, population) {
+        if (!m_networks.contains(net)) {
+            delete net;
+        }
+    }
 }
 
-bool NetworkEnsemble::paretoDominates(Network* n1, Network* n2)
+/*
+ * All the networks see the same samples, so they are evaluated together (see EvaluationScheduler).
+ */
+void NetworkEnsemble::computeAverageErrors(const QList< Network* >& population, const QList< InputSample* >& set)
 {
-    if (n1->averageError() < n2->averageError() && n1->complexity() <= n2->complexity()) {
-        return true;
-    }
+    QVector< double > errors = m_scheduler.averageErrors(population, set);
     
-    if (n1->complexity() < n2->complexity() && n1->averageError() <= n2->averageError()) {
-        return true;
+    for (int i = 0; i < population.size(); i++) {
+        population[i]->setAverageError(errors[i]);
     }
-    
-    return false;
 }
 
-QList< Network* > NetworkEnsemble::sortBySparsity(QList< Network* > front)
+void NetworkEnsemble::computeAverageErrors(const QList< Network* >& population, const TernarySampleSet& set)
 {
-    Q_FOREACH (Network* net, front) {
-        net->setSparsity(0);
+    QVector< double > errors = m_scheduler.averageErrors(population, set);
+    
+    for (int i = 0; i < population.size(); i++) {
+        population[i]->setAverageError(errors[i]);
     }
+}
+
+double NetworkEnsemble::test(QList< InputSample* >& testSamples)
+{    
+    TRACE_SPAN("test", "inference");
     
-    qSort(front.begin(), front.end(), NetworkEnsemble::lessThanError);
+    int right = 0;
+    int wrong = 0;
     
-    front.first()->setSparsity(INT_MAX);
-    front.last()->setSparsity(INT_MAX);
+    /*
+     * The total answer is the answer given by the maximum number of networks in the Pareto front.
+     */
+    m_voting.setNetworks(m_networks);
     
-    for (QList< Network* >::iterator it = front.begin() + 1; front.size() > 1 && it != front.end() - 1; it++) {        
-        double prevObj = (*(it - 1))->averageError();
-        double nextObj = (*(it + 1))->averageError();
-        
-        if ((*it)->sparsity() < INT_MAX) {
-            (*it)->addSparsity( nextObj - prevObj );
-        }
+    if (m_voting.order() == VotingEngine::AgreementOrder && !m_generationTest.isEmpty()) {
+        m_voting.calibrate(m_generationTest);
     }
     
-    qSort(front.begin(), front.end(), NetworkEnsemble::lessThanComplexity);
-    front.first()->setSparsity(INT_MAX);
-    front.last()->setSparsity(INT_MAX);
+    m_voting.resetStatistics();
+    QVector< int > votes = m_voting.votes(testSamples, &m_runtime);
     
-    for (QList< Network* >::iterator it = front.begin() + 1; front.size() > 1 && it != front.end() - 1; it++) {
-        int prevObj = (*(it - 1))->complexity();
-        int nextObj = (*(it + 1))->complexity();
-        
-        if ((*it)->sparsity() < INT_MAX) {
-            (*it)->addSparsity( nextObj - prevObj );
+    for (int s = 0; s < testSamples.size(); s++) {
+        if (votes[s] == (int)testSamples[s]->n_class) {
+            right++;
+        } else {
+            wrong++;
         }
     }
     
-    qSort(front.begin(), front.end(), NetworkEnsemble::lessThanSparsity);
-    return front;
+    cout << ":: Test results: " << right << " right answers and " << wrong << " wrong ones " << endl;
+    cout << ":: Networks consulted per sample: " << m_voting.averageConsulted() << " of " << m_networks.size() << endl;
+    
+    double rightPercentage = (double)right / (double)testSamples.size();
+    return rightPercentage;
+}
+
+VotingEngine* NetworkEnsemble::voting()
+{
+    return &m_voting;
 }
 
-bool NetworkEnsemble::lessThanError(const Network* n1, const Network* n2)
+TaskRuntime* NetworkEnsemble::runtime()
 {
-    return (n1->averageError() < n2->averageError());
+    return &m_runtime;
 }
 
-bool NetworkEnsemble::lessThanComplexity(const Network* n1, const Network* n2)
+MemoryFootprint NetworkEnsemble::memoryFootprint() const
 {
-    return (n1->complexity() < n2->complexity());
+    return populationFootprint(m_networks);
 }
 
-bool NetworkEnsemble::lessThanSparsity(const Network* n1, const Network* n2)
+MemoryFootprint NetworkEnsemble::populationFootprint(const QList< Network* >& population)
 {
-    return (n1->sparsity() < n2->sparsity());
+    MemoryFootprint footprint;
+    
+    Q_FOREACH (Network* net, population) {
+        footprint += net->memoryFootprint();
+    }
+    
+    footprint.index += MemoryFootprint::pointerList( population.size() );
+    return footprint;
+}
+
+/*
+ * The new population is generated by the previous one
+ */
+QList< Network* > NetworkEnsemble::breed(QList< Network* > parents)
+{
+    INSTRUMENT_PHASE(BreedingPhase);
+    TRACE_SPAN("breed", "training");
+    
+    /*
+     * IDs are given out here, so they don't depend on the order the tasks run in.
+     */
+    QVector< Network* > children(parents.size(), 0);
+    TaskGroup group;
+    
+    for (int i = 0; i < parents.size(); i++) {
+        m_runtime.submit(new BreedTask(parents[i], m_nextId++, &children[i]), &group);
+    }
+    
+    m_runtime.wait(&group);
+    return children.toList();
 }
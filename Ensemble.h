@@ -6,51 +6,206 @@
 #define ENSEMBLE_H
 
 #include <QList>
+#include <QMutex>
 #include "Network.h"
+#include "Configuration.h"
 #include "ProblemInfo.h"
+#include "EvaluationScheduler.h"
+#include "TernarySampleSet.h"
+#include "TaskRuntime.h"
+#include "ParetoArchive.h"
+#include "TrainingBudget.h"
+#include "VotingEngine.h"
+#include "EnsembleCompactor.h"
+#include "EnsembleDistiller.h"
 
 class NetworkEnsemble
 {
 public:
-    explicit NetworkEnsemble(int);
+    /*
+     * The parameters are the number of networks, the number of worker threads used for training and testing,
+     * and whether the workers should be pinned to a CPU each (only on Linux).
+     */
+    explicit NetworkEnsemble(int, int threads = QThread::idealThreadCount(), bool pinThreads = false);
+    
+    /*
+     * Same, with populationSize networks trained as the configuration says; the configuration must be
+     * valid (see Configuration::isValid()).
+     */
+    explicit NetworkEnsemble(const Configuration &, int threads = QThread::idealThreadCount(),
+                             bool pinThreads = false);
     virtual ~NetworkEnsemble();
     
+    const Configuration& configuration() const;
+    
     /*
      * For training we need two lists: the first contains training samples, the second a subset of test samples
-     * used to measure a network's performance between two epochs.
+     * used to measure a network's performance between two epochs. It runs for the epochs of the configuration.
      */
     void training(QList< InputSample* >&, QList< InputSample* > &);
     
+    /*
+     * Same as training(), for as long as the budget allows; the budget is started here, and tells
+     * afterwards why the training stopped.
+     */
+    void training(QList< InputSample* >&, QList< InputSample* > &, TrainingBudget &);
+    
+    /*
+     * The same training in steps, so other work can be done between epochs (e.g. migrations between
+     * islands): beginTraining() takes the samples, trainEpoch() runs one epoch, and endTraining() keeps
+     * the best first Pareto front seen (the one currentFront() gives) as the networks of the ensemble.
+     */
+    void beginTraining(QList< InputSample* >&, QList< InputSample* > &);
+    void trainEpoch();
+    void endTraining();
+    int epoch() const;
+    
+    /*
+     * Replaces the samples of the training in progress, e.g. when they come from a stream: the whole
+     * population is measured on the new ones at the next epoch, and the best front starts over.
+     */
+    void replaceSamples(QList< InputSample* >&, QList< InputSample* > &);
+    
+    /*
+     * Whether training() packs the samples measuring the networks into bit masks (see TernarySampleSet),
+     * and computes the fitness from them; off by default. Samples whose attributes aren't all -1, 0 or 1
+     * are used as they are.
+     */
+    void setTernaryEncoding(bool);
+    bool ternaryEncoding() const;
+    
+    /*
+     * Copies of the first front with the largest hypervolume seen since the training began, which the
+     * caller owns. Can be called from any thread at any time, e.g. to use the ensemble before the
+     * training is over.
+     */
+    QList< Network* > currentFront() const;
+    
+    /*
+     * During the training: up to a given number of non-dominated networks, and a network coming from
+     * elsewhere, which joins the population at the next epoch (the ensemble takes ownership of it).
+     */
+    QList< Network* > emigrants(int) const;
+    void immigrate(Network *);
+    
+    /*
+     * Same as training(), but breeding, training and evaluation of the children overlap: each child
+     * replaces the worst network as soon as it has been evaluated, instead of waiting for its generation.
+     */
+    void pipelinedTraining(QList< InputSample* >&, QList< InputSample* > &);
+    
     /*
      * Tests the performance of a network, printing out some results on the command line. Returns the percentage
      * of right answers given on the set.
      */
     double test(QList< InputSample* >&);
     
+    /*
+     * The engine test() votes with, to set the order of the networks and the confidence margin; with
+     * AgreementOrder, the networks are calibrated on the samples used to measure them during training.
+     */
+    VotingEngine* voting();
+    
+    /*
+     * Replaces the networks of the ensemble, taking ownership of the new ones; takeNetworks() leaves the
+     * ensemble empty and gives up ownership.
+     */
+    void setNetworks(const QList< Network* > &);
+    QList< Network* > takeNetworks();
+    
+    /*
+     * After the training, merges identical networks, prunes links and drops networks not needed by the
+     * majority vote, keeping the results on some held-out samples (see EnsembleCompactor); this is the
+     * ensemble to export and serve.
+     */
+    EnsembleCompactor::Report compact(const QList< InputSample* > &);
+    
+    /*
+     * Trains a single network to give the answers of the ensemble on the training samples, plus the given
+     * number of synthetic ones, and reports how often it agrees with the ensemble on the evaluation
+     * samples and how much faster it is (see EnsembleDistiller). The caller owns the network.
+     */
+    Network* distill(const QList< InputSample* >& training, const QList< InputSample* >& evaluation,
+                     int syntheticSamples = 0);
+    
+    /*
+     * Saves the networks of the ensemble to a file, e.g. to warm-start a later training from them;
+     * returns false if the file can't be written.
+     */
+    bool saveNetworks(const QString& path) const;
+    
+    /*
+     * Replaces the networks with the ones saved in a file, to start the next training from them instead
+     * of random networks: if there are more than @populationSize, only the first ones are kept, and if
+     * there are fewer, the population is topped up with mutated clones of them, bred as children are.
+     * The networks get new IDs and a vote weight of 1. Returns false, leaving the ensemble as it was, if
+     * the file can't be read.
+     */
+    bool loadNetworks(const QString& path, int populationSize);
+    
+    /*
+     * Writes the networks of the ensemble as a standalone C++ header, in a namespace with the given name
+     * (see EnsembleExporter); returns false if the file can't be written.
+     */
+    bool exportHeader(const QString& path, const QString& name = "ensemble") const;
+    
+    /*
+     * Bytes taken by the networks currently in the ensemble, or by any population.
+     */
+    MemoryFootprint memoryFootprint() const;
+    static MemoryFootprint populationFootprint(const QList< Network* > &);
+    
+    /*
+     * The runtime running training, breeding and testing tasks (e.g. to read its statistics).
+     */
+    TaskRuntime* runtime();
+    
 private:
+    SharedConfiguration m_config; /* shared with the networks */
     QList< Network* > m_networks;
     int m_nextId; /* next available ID for a network */
     
+    TaskRuntime m_runtime;
+    EvaluationScheduler m_scheduler; /* used for fitness */
+    VotingEngine m_voting;
+    
     /*
-     * Finds how is the network performing, as a percentage of wrong answers over all the test set.
+     * State of the training in progress.
      */
-    double computeAverageError(Network *, const QList< InputSample* > &);
+    ParetoArchive m_archive;
+    QList< Network* > m_population;
+    QList< InputSample* > m_generationTraining;
+    QList< InputSample* > m_generationTest;
+    int m_archiveSize;
+    int m_epoch;
+    TernarySampleSet m_ternaryTest; /* m_generationTest packed, if enabled and possible */
+    bool m_ternaryEncoding;
     
     /*
-     * Functions needed for NSGA-II.
+     * Copies of the best front so far, for currentFront().
      */
-    QMap< int, QList< Network* > > computeParetoFrontRank(QList< Network* >);
-    QList< Network* > paretoFront(QList< Network* > &);
-    bool paretoDominates(Network *, Network *);
-    QList< Network* > breed(QList< Network* >);
-    QList< Network* > sortBySparsity(QList< Network* >);
+    mutable QMutex m_bestFrontLock;
+    QList< Network* > m_bestFront;
+    double m_bestHypervolume;
+    
+    /*
+     * Replaces the copies of the best front if the first front of the archive is better.
+     */
+    void keepBestFront();
+    
+    /*
+     * Finds how each network is performing, as a percentage of wrong answers over all the test set, and
+     * sets it as its average error.
+     */
+    void computeAverageErrors(const QList< Network* > &, const QList< InputSample* > &);
+    void computeAverageErrors(const QList< Network* > &, const TernarySampleSet &);
+    
+    void createNetworks(int);
     
     /*
-     * Functions needed to sort the network list when computing the sparsity of each network.
+     * Functions needed for NSGA-II.
      */
-    static bool lessThanError(const Network *, const Network *);
-    static bool lessThanComplexity(const Network *, const Network *);
-    static bool lessThanSparsity(const Network *, const Network *);
+    QList< Network* > breed(QList< Network* >);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "EnsembleCompactor.h"
+#include "BatchEvaluator.h"
+#include "DenseNetwork.h"
+
+#include <QHash>
+#include <QByteArray>
+#include <QtAlgorithms>
+
+/*
+ * Orders networks by decreasing complexity; stable sorting keeps the order of the front for ties.
+ */
+static bool moreComplex(const Network* net1, const Network* net2)
+{
+    return net1->complexity() > net2->complexity();
+}
+
+/*
+ * -0.0 and 0.0 give the same sums, but have different bytes.
+ */
+static void positiveZeros(double* values, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (values[i] == 0.0) {
+            values[i] = 0.0;
+        }
+    }
+}
+
+/*
+ * The weights of a network, field by field, so padding doesn't get in the way of comparisons.
+ */
+static QByteArray denseKey(const Network* net)
+{
+    DenseNetwork dense;
+    net->toDense(&dense);
+
+    positiveZeros(dense.inputWeights, INPUT_SIZE);
+    positiveZeros(dense.inputBias, INPUT_SIZE);
+    positiveZeros(&dense.hiddenWeights[0][0], HIDDEN_SIZE_MAX * INPUT_SIZE);
+    positiveZeros(dense.hiddenBias, HIDDEN_SIZE_MAX);
+    positiveZeros(dense.outputWeights, HIDDEN_SIZE_MAX);
+    positiveZeros(&dense.outputBias, 1);
+
+    QByteArray key;
+    key.append( (const char*)&dense.hiddenCount, sizeof(dense.hiddenCount) );
+    key.append( (const char*)dense.inputWeights, sizeof(dense.inputWeights) );
+    key.append( (const char*)dense.inputBias, sizeof(dense.inputBias) );
+    key.append( (const char*)dense.hiddenWeights, sizeof(dense.hiddenWeights) );
+    key.append( (const char*)dense.hiddenBias, sizeof(dense.hiddenBias) );
+    key.append( (const char*)dense.outputWeights, sizeof(dense.outputWeights) );
+    key.append( (const char*)&dense.outputBias, sizeof(dense.outputBias) );
+
+    return key;
+}
+
+EnsembleCompactor::EnsembleCompactor(const QList< InputSample* >& heldOut)
+    : m_heldOut(heldOut)
+{
+    m_report.networksBefore = 0;
+    m_report.networksAfter = 0;
+    m_report.merged = 0;
+    m_report.dropped = 0;
+    m_report.linksBefore = 0;
+    m_report.linksAfter = 0;
+}
+
+EnsembleCompactor::~EnsembleCompactor()
+{}
+
+QList< Network* > EnsembleCompactor::compact(const QList< Network* >& networks)
+{
+    m_report.networksBefore = networks.size();
+    m_report.linksBefore = totalLinks(networks);
+
+    QList< Network* > compacted = mergeEquivalent( mergeIdentical(networks) );
+
+    for (int n = 0; n < compacted.size(); n++) {
+        compacted[n] = pruneLinks(compacted[n]);
+    }
+
+    compacted = dropRedundant(compacted);
+
+    m_report.networksAfter = compacted.size();
+    m_report.linksAfter = totalLinks(compacted);
+
+    return compacted;
+}
+
+EnsembleCompactor::Report EnsembleCompactor::report() const
+{
+    return m_report;
+}
+
+/*
+ * Networks with the same dense weights give the same class to any input, with the same evaluation
+ * kernels; the first of them stays.
+ */
+QList< Network* > EnsembleCompactor::mergeIdentical(const QList< Network* >& networks)
+{
+    QHash< QByteArray, Network* > seen;
+    QList< Network* > unique;
+
+    Q_FOREACH (Network* net, networks) {
+        QByteArray key = denseKey(net);
+        Network* same = seen.value(key, NULL);
+
+        if (same) {
+            same->setVoteWeight( same->voteWeight() + net->voteWeight() );
+            delete net;
+
+            m_report.merged++;
+            continue;
+        }
+
+        seen.insert(key, net);
+        unique.append(net);
+    }
+
+    return unique;
+}
+
+/*
+ * Networks giving the same class to every held-out sample only differ elsewhere; the least complex of
+ * them stays, the first one for ties.
+ */
+QList< Network* > EnsembleCompactor::mergeEquivalent(const QList< Network* >& networks)
+{
+    QHash< QByteArray, int > seen;
+    QList< Network* > unique;
+
+    Q_FOREACH (Network* net, networks) {
+        QVector< char > answers = classes(net);
+        QByteArray key(answers.constData(), answers.size());
+
+        if (!seen.contains(key)) {
+            seen.insert(key, unique.size());
+            unique.append(net);
+            continue;
+        }
+
+        int index = seen.value(key);
+        Network* kept = (net->complexity() < unique[index]->complexity()) ? net : unique[index];
+        Network* merged = (kept == net) ? unique[index] : net;
+
+        kept->setVoteWeight( kept->voteWeight() + merged->voteWeight() );
+        unique[index] = kept;
+        delete merged;
+
+        m_report.merged++;
+    }
+
+    return unique;
+}
+
+/*
+ * A link is tried on a copy of the network, which replaces it if the classes stay the same.
+ */
+Network* EnsembleCompactor::pruneLinks(Network* net)
+{
+    QVector< char > reference = classes(net);
+
+    typedef QPair< int, int > LinkPair;
+
+    Q_FOREACH (const LinkPair& link, net->removableLinks()) {
+        Network* candidate = new Network(net, net->id());
+        candidate->removeLink(link.first, link.second);
+
+        if (classes(candidate) == reference) {
+            delete net;
+            net = candidate;
+        } else {
+            delete candidate;
+        }
+    }
+
+    return net;
+}
+
+/*
+ * The votes for class 1 and the total votes on each sample are kept up to date as networks are dropped,
+ * so trying one only takes a pass over the samples.
+ */
+QList< Network* > EnsembleCompactor::dropRedundant(const QList< Network* >& networks)
+{
+    int samples = m_heldOut.size();
+
+    QHash< Network*, QVector< char > > answers;
+    QVector< int > ones(samples, 0);
+    int total = 0;
+
+    Q_FOREACH (Network* net, networks) {
+        answers.insert(net, classes(net));
+        total += net->voteWeight();
+
+        for (int s = 0; s < samples; s++) {
+            ones[s] += answers[net][s] * net->voteWeight();
+        }
+    }
+
+    QVector< char > reference(samples);
+
+    for (int s = 0; s < samples; s++) {
+        reference[s] = (ones[s] > total - ones[s]) ? 1 : 0;
+    }
+
+    QList< Network* > candidates = networks;
+    qStableSort(candidates.begin(), candidates.end(), moreComplex);
+
+    QList< Network* > kept = networks;
+
+    Q_FOREACH (Network* net, candidates) {
+        if (kept.size() == 1) {
+            break;
+        }
+
+        const QVector< char >& classes = answers[net];
+        int weight = net->voteWeight();
+        bool redundant = true;
+
+        for (int s = 0; s < samples && redundant; s++) {
+            int remainingOnes = ones[s] - classes[s] * weight;
+            int remainingTotal = total - weight;
+
+            redundant = ((remainingOnes > remainingTotal - remainingOnes) ? 1 : 0) == reference[s];
+        }
+
+        if (!redundant) {
+            continue;
+        }
+
+        for (int s = 0; s < samples; s++) {
+            ones[s] -= classes[s] * weight;
+        }
+
+        total -= weight;
+        kept.removeOne(net);
+        delete net;
+
+        m_report.dropped++;
+    }
+
+    return kept;
+}
+
+QVector< char > EnsembleCompactor::classes(Network* net) const
+{
+    QList< Network* > single;
+    single.append(net);
+
+    QVector< char > classes;
+    BatchEvaluator(1).classify(single, m_heldOut, classes);
+
+    return classes;
+}
+
+int EnsembleCompactor::totalLinks(const QList< Network* >& networks)
+{
+    int links = 0;
+
+    Q_FOREACH (const Network* net, networks) {
+        links += net->complexity();
+    }
+
+    return links;
+}
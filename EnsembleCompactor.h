@@ -0,0 +1,67 @@
+/*
+ * Makes a trained ensemble cheaper to evaluate, in four passes over a set of held-out samples:
+ *
+ * - identical networks (same weights, neuron by neuron, -0.0 counting as 0.0) are merged into one, whose
+ *   vote weight is the sum of theirs, so the votes don't change anywhere;
+ * - networks giving the same class to every held-out sample are merged the same way, into the least
+ *   complex of them;
+ * - from each network, the links whose removal doesn't change the class it gives to any held-out sample
+ *   are removed, one at a time;
+ * - networks are dropped, the most complex first, as long as the majority vote on every held-out sample
+ *   stays the same.
+ *
+ * The last three passes only keep the results on the held-out samples, so those should be representative.
+ */
+
+#ifndef ENSEMBLECOMPACTOR_H
+#define ENSEMBLECOMPACTOR_H
+
+#include <QList>
+#include <QVector>
+
+#include "Network.h"
+#include "ProblemInfo.h"
+
+class EnsembleCompactor
+{
+public:
+    /*
+     * What a compaction has done.
+     */
+    struct Report {
+        int networksBefore;
+        int networksAfter;
+        int merged;   /* networks merged into identical or equivalent ones */
+        int dropped;  /* networks not needed by the majority */
+        int linksBefore;
+        int linksAfter;
+    };
+
+    explicit EnsembleCompactor(const QList< InputSample* >& heldOut);
+    virtual ~EnsembleCompactor();
+
+    /*
+     * Takes ownership of the networks, and returns the ones left; the others are deleted.
+     */
+    QList< Network* > compact(const QList< Network* > &);
+
+    Report report() const;
+
+private:
+    QList< Network* > mergeIdentical(const QList< Network* > &);
+    QList< Network* > mergeEquivalent(const QList< Network* > &);
+    Network* pruneLinks(Network *);
+    QList< Network* > dropRedundant(const QList< Network* > &);
+
+    /*
+     * The class given by a network to every held-out sample.
+     */
+    QVector< char > classes(Network *) const;
+
+    static int totalLinks(const QList< Network* > &);
+
+    QList< InputSample* > m_heldOut;
+    Report m_report;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "EnsembleDistiller.h"
+#include "BatchEvaluator.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+#include <QElapsedTimer>
+
+EnsembleDistiller::EnsembleDistiller(const QList< Network* >& ensemble)
+    : m_ensemble(ensemble)
+    , m_epochs(100)
+    , m_syntheticSamples(0)
+{
+    m_report.agreement = 0;
+    m_report.ensembleLinks = 0;
+    m_report.studentLinks = 0;
+    m_report.ensembleNsecs = 0;
+    m_report.studentNsecs = 0;
+    m_report.speedup = 0;
+}
+
+EnsembleDistiller::~EnsembleDistiller()
+{}
+
+void EnsembleDistiller::setEpochs(int epochs)
+{
+    m_epochs = epochs;
+}
+
+void EnsembleDistiller::setSyntheticSamples(int count)
+{
+    m_syntheticSamples = count;
+}
+
+Network* EnsembleDistiller::distill(const QList< InputSample* >& training, const QList< InputSample* >& evaluation, int id)
+{
+    TRACE_SPAN("distillation", "training");
+
+    QList< InputSample* > synthetic = syntheticSamples(training);
+    QList< InputSample* > transfer = training + synthetic;
+
+    QVector< double > targets;
+    QVector< char > majority;
+    softVotes(transfer, &targets, &majority);
+
+    for (int s = 0; s < targets.size(); s++) {
+        targets[s] = 2.0 * targets[s] - 1.0;
+    }
+
+    /*
+     * The teacher closest to the majority is the best place to start from.
+     */
+    Network* best = NULL;
+    double bestAgreement = -1.0;
+
+    Q_FOREACH (Network* net, m_ensemble) {
+        double netAgreement = agreement(net, transfer, majority);
+
+        if (netAgreement > bestAgreement) {
+            best = net;
+            bestAgreement = netAgreement;
+        }
+    }
+
+    Network* student = best ? new Network(best, id) : new Network(id);
+    student->setVoteWeight(1);
+
+    best = new Network(student, id);
+    bestAgreement = agreement(best, transfer, majority);
+
+    for (int epoch = 0; epoch < m_epochs; epoch++) {
+        /*
+         * At the first iteration the "previous gradient" isn't defined, so rprop is skipped, as in the
+         * training of the ensemble.
+         */
+        for (int s = 0; s < transfer.size(); s++) {
+            student->applyTarget(transfer[s]->attributes, targets[s]);
+
+            if (s > 0) {
+                student->updateByRProp();
+            }
+        }
+
+        double studentAgreement = agreement(student, transfer, majority);
+
+        if (studentAgreement > bestAgreement) {
+            delete best;
+            best = new Network(student, id);
+            bestAgreement = studentAgreement;
+        }
+    }
+
+    delete student;
+    qDeleteAll(synthetic);
+
+    /*
+     * Both are timed on one thread with the same kernels, voting included for the ensemble.
+     */
+    QVector< char > evaluationMajority;
+    QElapsedTimer timer;
+
+    timer.start();
+    softVotes(evaluation, NULL, &evaluationMajority);
+    m_report.ensembleNsecs = timer.nsecsElapsed();
+
+    timer.start();
+    m_report.agreement = agreement(best, evaluation, evaluationMajority);
+    m_report.studentNsecs = timer.nsecsElapsed();
+
+    m_report.speedup = (double)m_report.ensembleNsecs / (double)qMax(m_report.studentNsecs, (qint64)1);
+    m_report.studentLinks = best->complexity();
+    m_report.ensembleLinks = 0;
+
+    Q_FOREACH (const Network* net, m_ensemble) {
+        m_report.ensembleLinks += net->complexity();
+    }
+
+    return best;
+}
+
+EnsembleDistiller::Report EnsembleDistiller::report() const
+{
+    return m_report;
+}
+
+void EnsembleDistiller::softVotes(const QList< InputSample* >& samples, QVector< double >* votes,
+                                  QVector< char >* classes) const
+{
+    QVector< char > answers;
+    BatchEvaluator(qMax(m_ensemble.size(), 1)).classify(m_ensemble, samples, answers);
+
+    int total = 0;
+
+    Q_FOREACH (const Network* net, m_ensemble) {
+        total += net->voteWeight();
+    }
+
+    if (votes) {
+        votes->resize(samples.size());
+    }
+
+    classes->resize(samples.size());
+
+    for (int s = 0; s < samples.size(); s++) {
+        int ones = 0;
+
+        for (int n = 0; n < m_ensemble.size(); n++) {
+            ones += answers[n * samples.size() + s] * m_ensemble[n]->voteWeight();
+        }
+
+        if (votes) {
+            (*votes)[s] = total ? (double)ones / (double)total : 0.0;
+        }
+
+        (*classes)[s] = (ones > total - ones) ? 1 : 0;
+    }
+}
+
+double EnsembleDistiller::agreement(Network* net, const QList< InputSample* >& samples, const QVector< char >& classes)
+{
+    if (samples.isEmpty()) {
+        return 0.0;
+    }
+
+    QList< Network* > single;
+    single.append(net);
+
+    QVector< char > answers;
+    BatchEvaluator(1).classify(single, samples, answers);
+
+    int agreeing = 0;
+
+    for (int s = 0; s < samples.size(); s++) {
+        if (answers[s] == classes[s]) {
+            agreeing++;
+        }
+    }
+
+    return (double)agreeing / (double)samples.size();
+}
+
+/*
+ * Every attribute comes from a random training sample, so the synthetic samples follow the distribution
+ * of each attribute, but not the correlations between them. Their class is left to the ensemble.
+ */
+QList< InputSample* > EnsembleDistiller::syntheticSamples(const QList< InputSample* >& training) const
+{
+    QList< InputSample* > synthetic;
+
+    if (training.isEmpty()) {
+        return synthetic;
+    }
+
+    for (int s = 0; s < m_syntheticSamples; s++) {
+        InputSample* sample = new InputSample;
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            sample->attributes[i] = training[ randomInteger(0, training.size()) ]->attributes[i];
+        }
+
+        synthetic.append(sample);
+    }
+
+    return synthetic;
+}
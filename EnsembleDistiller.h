@@ -0,0 +1,73 @@
+/*
+ * Distills an ensemble into a single network, to serve one network instead of a whole front. The
+ * student is trained with RPROP, as the networks of the ensemble are, but its target on each sample is the
+ * soft vote of the ensemble, the fraction of votes for class 1 mapped to [-1, 1], instead of the class of
+ * the sample. It can also learn on synthetic inputs, made by drawing every attribute from a different
+ * training sample, where only the ensemble says what the answer is.
+ *
+ * The student starts as a copy of the network of the ensemble that agrees most with the majority, and
+ * the best student seen during training is kept.
+ */
+
+#ifndef ENSEMBLEDISTILLER_H
+#define ENSEMBLEDISTILLER_H
+
+#include <QList>
+#include <QVector>
+
+#include "Network.h"
+#include "ProblemInfo.h"
+
+class EnsembleDistiller
+{
+public:
+    /*
+     * How close the student is to the ensemble on the evaluation samples, and how much cheaper.
+     */
+    struct Report {
+        double agreement;     /* fraction of samples where the student gives the majority class */
+        int ensembleLinks;
+        int studentLinks;
+        qint64 ensembleNsecs; /* to classify the evaluation samples */
+        qint64 studentNsecs;
+        double speedup;
+    };
+
+    /*
+     * The networks of the ensemble are only read, with their vote weights.
+     */
+    explicit EnsembleDistiller(const QList< Network* > &);
+    virtual ~EnsembleDistiller();
+
+    void setEpochs(int);
+    void setSyntheticSamples(int);
+
+    /*
+     * Trains a student with the given ID on the training samples (and the synthetic ones), and measures
+     * it on the evaluation samples. The caller owns the student.
+     */
+    Network* distill(const QList< InputSample* >& training, const QList< InputSample* >& evaluation, int id);
+
+    Report report() const;
+
+private:
+    /*
+     * The fraction of votes for class 1 on each sample, and the majority class.
+     */
+    void softVotes(const QList< InputSample* > &, QVector< double >* votes, QVector< char >* classes) const;
+
+    /*
+     * The fraction of samples on which a network gives the given classes.
+     */
+    static double agreement(Network *, const QList< InputSample* > &, const QVector< char > &);
+
+    QList< InputSample* > syntheticSamples(const QList< InputSample* > &) const;
+
+    QList< Network* > m_ensemble;
+    int m_epochs;
+    int m_syntheticSamples;
+
+    Report m_report;
+};
+
+#endif
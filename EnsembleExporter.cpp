@@ -0,0 +1,187 @@
+#include "EnsembleExporter.h"
+
+#include <QFile>
+
+/*
+ * 17 significant digits are enough to read back any double exactly.
+ */
+static void writeArray(const double* values, int count, QTextStream& out)
+{
+    out << "{ ";
+
+    for (int i = 0; i < count; i++) {
+        out << (i > 0 ? ", " : "") << values[i];
+    }
+
+    out << " }";
+}
+
+EnsembleExporter::EnsembleExporter(const QString& name)
+    : m_name(name)
+{}
+
+EnsembleExporter::~EnsembleExporter()
+{}
+
+bool EnsembleExporter::writeHeader(const QList< Network* >& networks, const QString& path) const
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    generate(networks, out);
+
+    out.flush();
+    file.close();
+
+    return true;
+}
+
+void EnsembleExporter::generate(const QList< Network* >& networks, QTextStream& out) const
+{
+    QString guard = m_name.toUpper() + "_H";
+    int totalWeight = 0;
+
+    Q_FOREACH (const Network* net, networks) {
+        totalWeight += net->voteWeight();
+    }
+
+    out.setRealNumberNotation(QTextStream::SmartNotation);
+    out.setRealNumberPrecision(17);
+
+    out << "/*\n"
+        << " * Generated from an ensemble of " << networks.size() << " networks; do not edit.\n"
+        << " * Compile without floating point contraction (e.g. -ffp-contract=off) to get exactly the\n"
+        << " * classes the ensemble gives.\n"
+        << " */\n\n"
+        << "#ifndef " << guard << "\n"
+        << "#define " << guard << "\n\n"
+        << "#include <cmath>\n\n"
+        << "namespace " << m_name << " {\n\n"
+        << "constexpr int INPUT_SIZE = " << INPUT_SIZE << ";\n"
+        << "constexpr int NETWORK_COUNT = " << networks.size() << ";\n"
+        << "constexpr int TOTAL_WEIGHT = " << totalWeight << ";\n\n"
+        << "inline double sigmoid(double z)\n"
+        << "{\n"
+        << "    return 1.0f / (1.0f + std::exp(-z));\n"
+        << "}\n\n";
+
+    DenseNetwork dense;
+
+    for (int n = 0; n < networks.size(); n++) {
+        QString prefix = QString("network%1").arg(n);
+
+        networks[n]->toDense(&dense);
+        writeWeights(prefix, dense, out);
+        writeForward(prefix, dense, out);
+    }
+
+    /*
+     * Each network votes 0 or 1 as many times as its vote weight, so class 1 needs more than half of the
+     * votes.
+     */
+    out << "/*\n"
+        << " * The class chosen by most of the votes; ties go to class 0.\n"
+        << " */\n"
+        << "inline int classify(const double x[INPUT_SIZE])\n"
+        << "{\n"
+        << "    int votes = 0;\n";
+
+    for (int n = 0; n < networks.size(); n++) {
+        out << "    votes += " << networks[n]->voteWeight() << " * network" << n << "(x);\n";
+    }
+
+    out << "    return (votes > TOTAL_WEIGHT - votes) ? 1 : 0;\n"
+        << "}\n\n"
+        << "}\n\n"
+        << "#endif\n";
+}
+
+void EnsembleExporter::writeWeights(const QString& prefix, const DenseNetwork& dense, QTextStream& out) const
+{
+    out << "constexpr double " << prefix << "_input_weights[INPUT_SIZE] = ";
+    writeArray(dense.inputWeights, INPUT_SIZE, out);
+
+    out << ";\nconstexpr double " << prefix << "_input_bias[INPUT_SIZE] = ";
+    writeArray(dense.inputBias, INPUT_SIZE, out);
+    out << ";\n";
+
+    if (dense.hiddenCount > 0) {
+        out << "constexpr double " << prefix << "_hidden_weights[" << dense.hiddenCount << "][INPUT_SIZE] = {\n";
+
+        for (int h = 0; h < dense.hiddenCount; h++) {
+            out << "    ";
+            writeArray(dense.hiddenWeights[h], INPUT_SIZE, out);
+            out << (h + 1 < dense.hiddenCount ? ",\n" : "\n");
+        }
+
+        out << "};\nconstexpr double " << prefix << "_hidden_bias[" << dense.hiddenCount << "] = ";
+        writeArray(dense.hiddenBias, dense.hiddenCount, out);
+
+        out << ";\nconstexpr double " << prefix << "_output_weights[" << dense.hiddenCount << "] = ";
+        writeArray(dense.outputWeights, dense.hiddenCount, out);
+        out << ";\n";
+    }
+
+    out << "constexpr double " << prefix << "_output_bias = " << dense.outputBias << ";\n\n";
+}
+
+/*
+ * Adding a missing link's zero product leaves a sum as it is, so such links are simply left out, as are
+ * the hidden neurons not linked to the output and the inputs no neuron uses.
+ */
+void EnsembleExporter::writeForward(const QString& prefix, const DenseNetwork& dense, QTextStream& out) const
+{
+    bool usedHidden[HIDDEN_SIZE_MAX];
+    bool usedInputs[INPUT_SIZE];
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        usedInputs[i] = false;
+    }
+
+    for (int h = 0; h < dense.hiddenCount; h++) {
+        usedHidden[h] = (dense.outputWeights[h] != 0.0);
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            if (usedHidden[h] && dense.hiddenWeights[h][i] != 0.0) {
+                usedInputs[i] = true;
+            }
+        }
+    }
+
+    out << "inline int " << prefix << "(const double x[INPUT_SIZE])\n"
+        << "{\n";
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        if (usedInputs[i]) {
+            out << "    const double in" << i << " = sigmoid(x[" << i << "] * " << prefix << "_input_weights[" << i
+                << "] + " << prefix << "_input_bias[" << i << "]);\n";
+        }
+    }
+
+    out << "    double z = " << prefix << "_output_bias;\n";
+
+    for (int h = 0; h < dense.hiddenCount; h++) {
+        if (!usedHidden[h]) {
+            continue;
+        }
+
+        out << "    {\n"
+            << "        double zh = " << prefix << "_hidden_bias[" << h << "];\n";
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            if (dense.hiddenWeights[h][i] != 0.0) {
+                out << "        zh += " << prefix << "_hidden_weights[" << h << "][" << i << "] * in" << i << ";\n";
+            }
+        }
+
+        out << "        z += " << prefix << "_output_weights[" << h << "] * sigmoid(zh);\n"
+            << "    }\n";
+    }
+
+    out << "    return (z > 0.0) ? 1 : 0;\n"
+        << "}\n\n";
+}
@@ -0,0 +1,47 @@
+/*
+ * Writes the networks of an ensemble as a self-contained C++ header, so that samples can be classified
+ * where neither Qt nor this code is available. Every network becomes a set of constexpr weight arrays and
+ * a straight-line function computing its class, with the links a network doesn't have left out; a
+ * classify() function takes the majority vote as NetworkEnsemble::test() does, with the vote weights of
+ * the networks, ties going to class 0.
+ *
+ * The generated code computes the same sums in the same order as BatchEvaluator, and the weights are
+ * written with enough digits to be read back exactly, so it gives exactly the classes the ensemble gives
+ * as long as the compiler doesn't contract floating point operations: the kernels are built with
+ * -ffp-contract=off (see CMakeLists.txt), and the code including the header must be too. The header
+ * needs C++11 and <cmath>.
+ */
+
+#ifndef ENSEMBLEEXPORTER_H
+#define ENSEMBLEEXPORTER_H
+
+#include <QList>
+#include <QString>
+#include <QTextStream>
+
+#include "Network.h"
+#include "DenseNetwork.h"
+
+class EnsembleExporter
+{
+public:
+    /*
+     * The generated code goes in a namespace with the given name, which must be a valid identifier.
+     */
+    explicit EnsembleExporter(const QString& name = "ensemble");
+    virtual ~EnsembleExporter();
+
+    /*
+     * Writes the header for the networks to a file; returns false if it can't be written.
+     */
+    bool writeHeader(const QList< Network* > &, const QString& path) const;
+    void generate(const QList< Network* > &, QTextStream &) const;
+
+private:
+    void writeWeights(const QString& prefix, const DenseNetwork &, QTextStream &) const;
+    void writeForward(const QString& prefix, const DenseNetwork &, QTextStream &) const;
+
+    QString m_name;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "EvaluationScheduler.h"
+#include "Tracing.h"
+
+#include <unistd.h>
+
+/*
+ * Runs the tiles of one range.
+ */
+class TileRangeTask : public Task
+{
+public:
+    TileRangeTask(EvaluationScheduler* scheduler, int range)
+        : m_scheduler(scheduler)
+        , m_range(range)
+    {}
+    
+    virtual void run()
+    {
+        m_scheduler->work(m_range);
+    }
+    
+private:
+    EvaluationScheduler* m_scheduler;
+    int m_range;
+};
+
+EvaluationScheduler::EvaluationScheduler(TaskRuntime* runtime)
+    : m_runtime(runtime)
+    , m_ranges(runtime->workerCount())
+    , m_tileNetworks(0)
+    , m_tileSamples(0)
+    , m_samples(0)
+    , m_ternarySamples(0)
+    , m_classes(0)
+    , m_cursors(new QAtomicInt[m_ranges])
+{}
+
+EvaluationScheduler::~EvaluationScheduler()
+{
+    delete[] m_cursors;
+}
+
+int EvaluationScheduler::tileNetworks() const
+{
+    return m_tileNetworks;
+}
+
+int EvaluationScheduler::tileSamples() const
+{
+    return m_tileSamples;
+}
+
+int EvaluationScheduler::steals() const
+{
+    return m_steals;
+}
+
+int EvaluationScheduler::cacheSize(int level)
+{
+    long size = 0;
+    
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    size = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+#endif
+    
+    if (size <= 0) {
+        size = (level == 1) ? 32 * 1024 : 256 * 1024;
+    }
+    
+    return size;
+}
+
+/*
+ * Footprints of a packed network (see BatchEvaluator) and of a sample together with its row of results.
+ */
+void EvaluationScheduler::planTiles(int networks, int samples)
+{
+    int networkBytes = sizeof(int) + sizeof(PackedKernel) + NetworkLayout::Size * sizeof(double);
+    int sampleBytes = sizeof(InputSample) + sizeof(InputSample*);
+    
+    if (m_ternarySamples) {
+        networkBytes = sizeof(int) + TernaryNetworkLayout::Size * sizeof(double);
+        sampleBytes = sizeof(TernaryBoard) + sizeof(quint8);
+    }
+    
+    m_tileNetworks = qBound(1, (cacheSize(1) / 2) / networkBytes, qMax(networks, 1));
+    
+    int sampleSpace = cacheSize(2) / 2 - m_tileNetworks * networkBytes;
+    m_tileSamples = qBound(1, sampleSpace / (sampleBytes + m_tileNetworks), qMax(samples, 1));
+    
+    m_tiles.clear();
+    
+    for (int n = 0; n < networks; n += m_tileNetworks) {
+        for (int s = 0; s < samples; s += m_tileSamples) {
+            Tile tile;
+            tile.firstNetwork = n;
+            tile.networkCount = qMin(m_tileNetworks, networks - n);
+            tile.firstSample = s;
+            tile.sampleCount = qMin(m_tileSamples, samples - s);
+            
+            m_tiles.append(tile);
+        }
+    }
+    
+    m_ends.resize(m_ranges);
+    
+    for (int r = 0; r < m_ranges; r++) {
+        m_cursors[r] = (m_tiles.size() * r) / m_ranges;
+        m_ends[r] = (m_tiles.size() * (r + 1)) / m_ranges;
+    }
+    
+    m_steals = 0;
+}
+
+bool EvaluationScheduler::nextTile(int range, EvaluationScheduler::Tile* tile)
+{
+    for (int i = 0; i < m_ranges; i++) {
+        int victim = (range + i) % m_ranges;
+        int index = m_cursors[victim].fetchAndAddRelaxed(1);
+        
+        if (index < m_ends[victim]) {
+            if (victim != range) {
+                m_steals.fetchAndAddRelaxed(1);
+            }
+            
+            *tile = m_tiles[index];
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void EvaluationScheduler::work(int range)
+{
+    Tile tile;
+    
+    while (nextTile(range, &tile)) {
+        TRACE_SPAN_ARG("tile", "evaluation", tile.firstNetwork);
+        
+        if (m_ternarySamples) {
+            m_evaluator.evaluate(*m_ternarySamples, tile.firstNetwork, tile.networkCount,
+                                 tile.firstSample, tile.sampleCount, m_classes);
+        } else {
+            m_evaluator.evaluate(*m_samples, tile.firstNetwork, tile.networkCount,
+                                 tile.firstSample, tile.sampleCount, m_classes);
+        }
+    }
+}
+
+void EvaluationScheduler::classify(const QList< Network* >& networks, const QList< InputSample* >& samples,
+                                   QVector< char >& classes)
+{
+    m_evaluator.pack(networks);
+    classes.resize(networks.size() * samples.size());
+    
+    m_samples = &samples;
+    m_classes = classes.data();
+    runTiles(networks.size(), samples.size());
+    
+    m_samples = 0;
+    m_classes = 0;
+}
+
+void EvaluationScheduler::classify(const QList< Network* >& networks, const TernarySampleSet& samples,
+                                   QVector< char >& classes)
+{
+    m_evaluator.packTernary(networks);
+    classes.resize(networks.size() * samples.size());
+    
+    m_ternarySamples = &samples;
+    m_classes = classes.data();
+    runTiles(networks.size(), samples.size());
+    
+    m_ternarySamples = 0;
+    m_classes = 0;
+}
+
+void EvaluationScheduler::runTiles(int networks, int samples)
+{
+    planTiles(networks, samples);
+    TaskGroup group;
+    
+    for (int r = 0; r < m_ranges; r++) {
+        m_runtime->submit(new TileRangeTask(this, r), &group);
+    }
+    
+    m_runtime->wait(&group);
+}
+
+QVector< double > EvaluationScheduler::averageErrors(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    QVector< char > classes;
+    QVector< double > errors(networks.size(), 0.0);
+    
+    classify(networks, samples, classes);
+    
+    for (int n = 0; n < networks.size(); n++) {
+        int wrong = 0;
+        
+        for (int s = 0; s < samples.size(); s++) {
+            if (classes[n * samples.size() + s] != (int)samples[s]->n_class) {
+                wrong++;
+            }
+        }
+        
+        errors[n] = (double)wrong / (double)samples.size();
+    }
+    
+    return errors;
+}
+
+QVector< double > EvaluationScheduler::averageErrors(const QList< Network* >& networks, const TernarySampleSet& samples)
+{
+    QVector< char > classes;
+    QVector< double > errors(networks.size(), 0.0);
+    
+    classify(networks, samples, classes);
+    
+    for (int n = 0; n < networks.size(); n++) {
+        int wrong = 0;
+        
+        for (int s = 0; s < samples.size(); s++) {
+            if (classes[n * samples.size() + s] != samples.sampleClass(s)) {
+                wrong++;
+            }
+        }
+        
+        errors[n] = (double)wrong / (double)samples.size();
+    }
+    
+    return errors;
+}
+
+QVector< int > EvaluationScheduler::majorityVotes(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    QVector< char > classes;
+    QVector< int > votes(samples.size(), 0);
+    
+    classify(networks, samples, classes);
+    
+    for (int s = 0; s < samples.size(); s++) {
+        int answers[NUM_CLASSES];
+        
+        for (int i = 0; i < NUM_CLASSES; i++) {
+            answers[i] = 0;
+        }
+        
+        for (int n = 0; n < networks.size(); n++) {
+            answers[ (int)classes[n * samples.size() + s] ] += networks[n]->voteWeight();
+        }
+        
+        int max = 0;
+        
+        for (int i = 0; i < NUM_CLASSES; i++) {
+            if (answers[i] > max) {
+                max = answers[i];
+                votes[s] = i;
+            }
+        }
+    }
+    
+    return votes;
+}
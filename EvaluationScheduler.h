@@ -0,0 +1,100 @@
+/*
+ * Schedules the evaluation of many networks on many samples for cache locality. The (network x sample)
+ * grid is split into tiles: a tile takes as many networks as fit in half of the L1 cache (with their
+ * packed weights, see BatchEvaluator), and as many samples as fit in what is left of half the L2 cache.
+ * 
+ * Tiles are handed out in contiguous ranges, one for each worker of a TaskRuntime, so consecutive tiles of
+ * a worker share the same networks; a worker that runs out of tiles steals the next ones from the other
+ * ranges.
+ * 
+ * The same scheduler is used to compute the fitness of a population and the votes of an ensemble.
+ */
+
+#ifndef EVALUATIONSCHEDULER_H
+#define EVALUATIONSCHEDULER_H
+
+#include <QList>
+#include <QVector>
+#include <QAtomicInt>
+
+#include "BatchEvaluator.h"
+#include "TaskRuntime.h"
+
+class EvaluationScheduler
+{
+public:
+    /*
+     * Tiles are run as tasks of @runtime, which must outlive the scheduler.
+     */
+    explicit EvaluationScheduler(TaskRuntime *);
+    virtual ~EvaluationScheduler();
+    
+    /*
+     * The class given by network n to sample s goes in classes[n * samples.size() + s].
+     */
+    void classify(const QList< Network* > &, const QList< InputSample* > &, QVector< char > &);
+    void classify(const QList< Network* > &, const TernarySampleSet &, QVector< char > &);
+    
+    /*
+     * The fraction of wrong answers of each network on the samples.
+     */
+    QVector< double > averageErrors(const QList< Network* > &, const QList< InputSample* > &);
+    QVector< double > averageErrors(const QList< Network* > &, const TernarySampleSet &);
+    
+    /*
+     * The class chosen by most of the networks for each sample, each network casting as many votes as
+     * its vote weight; ties go to the smallest class.
+     */
+    QVector< int > majorityVotes(const QList< Network* > &, const QList< InputSample* > &);
+    
+    /*
+     * Shape of the tiles and number of tiles stolen in the last evaluation.
+     */
+    int tileNetworks() const;
+    int tileSamples() const;
+    int steals() const;
+    
+    /*
+     * Size in bytes of the level 1 or level 2 data cache, with a conservative default if unknown.
+     */
+    static int cacheSize(int level);
+    
+private:
+    struct Tile {
+        int firstNetwork;
+        int networkCount;
+        int firstSample;
+        int sampleCount;
+    };
+    
+    friend class TileRangeTask;
+    
+    /*
+     * Tiles are sized for the samples being evaluated, either m_samples or m_ternarySamples.
+     */
+    void planTiles(int networks, int samples);
+    void runTiles(int networks, int samples);
+    
+    /*
+     * Takes the next tile of @range, or steals one; returns false when there are no tiles left.
+     */
+    bool nextTile(int range, Tile *);
+    void work(int range);
+    
+    TaskRuntime* m_runtime;
+    int m_ranges;
+    int m_tileNetworks;
+    int m_tileSamples;
+    
+    BatchEvaluator m_evaluator;
+    const QList< InputSample* >* m_samples;
+    const TernarySampleSet* m_ternarySamples;
+    char* m_classes;
+    
+    QVector< Tile > m_tiles;
+    QVector< int > m_ends; /* each range goes from its cursor up to here */
+    QAtomicInt* m_cursors;
+    QAtomicInt m_steals;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "FixedKernel.h"
+
+#include <QtGlobal>
+
+#define FIXED_KERNEL_LAST_HIDDEN \
+    (HIDDEN_SIZE_MAX < FIXED_KERNEL_MAX_HIDDEN ? HIDDEN_SIZE_MAX : FIXED_KERNEL_MAX_HIDDEN)
+
+double genericKernel(const double* record, int hiddenCount, const double* x)
+{
+    double inputs[INPUT_SIZE];
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        inputs[i] = sigmoid(x[i] * record[NetworkLayout::InputWeights + i] + record[NetworkLayout::InputBias + i]);
+    }
+
+    double z = record[NetworkLayout::OutputBias];
+
+    for (int h = 0; h < hiddenCount; h++) {
+        const double* weights = record + NetworkLayout::HiddenWeights + h * INPUT_SIZE;
+        double zh = record[NetworkLayout::HiddenBias + h];
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            zh += weights[i] * inputs[i];
+        }
+
+        z += record[NetworkLayout::OutputWeights + h] * sigmoid(zh);
+    }
+
+    return z;
+}
+
+/*
+ * Puts the kernels for Hidden to Last hidden neurons into a table.
+ */
+template < int Hidden, int Last, bool Done = (Hidden > Last) >
+struct FixedKernelRange
+{
+    static void fill(PackedKernel* kernels)
+    {
+        kernels[Hidden] = &FixedKernel< INPUT_SIZE, HIDDEN_SIZE_MAX, Hidden >::output;
+        FixedKernelRange< Hidden + 1, Last >::fill(kernels);
+    }
+};
+
+template < int Hidden, int Last >
+struct FixedKernelRange< Hidden, Last, true >
+{
+    static void fill(PackedKernel *)
+    {}
+};
+
+struct PackedKernelTable
+{
+    PackedKernelTable()
+    {
+        for (int h = 0; h <= HIDDEN_SIZE_MAX; h++) {
+            kernels[h] = &genericKernel;
+        }
+
+#if INPUT_SIZE <= FIXED_KERNEL_MAX_INPUTS
+        FixedKernelRange< HIDDEN_SIZE_MIN, FIXED_KERNEL_LAST_HIDDEN >::fill(kernels);
+#endif
+    }
+
+    PackedKernel kernels[HIDDEN_SIZE_MAX + 1];
+};
+
+Q_GLOBAL_STATIC(PackedKernelTable, s_kernels);
+
+PackedKernel packedKernel(int hiddenCount)
+{
+    if (hiddenCount < 0 || hiddenCount > HIDDEN_SIZE_MAX) {
+        return &genericKernel;
+    }
+
+    return s_kernels()->kernels[hiddenCount];
+}
@@ -0,0 +1,166 @@
+/*
+ * Evaluation kernels specialized at compile time on the shape of a network. A network is packed into a
+ * flat record of weights, whose layout only depends on the number of inputs and on the maximum number of
+ * hidden neurons, so the offset of every layer is a compile-time constant. FixedKernel is then
+ * instantiated for each number of hidden neurons: all its loops have constant trip counts, and are
+ * unrolled by template recursion.
+ *
+ * Kernels are picked at run time by packedKernel(), from the hidden count of the network. Only the
+ * hidden counts a network can have (HIDDEN_SIZE_MIN to HIDDEN_SIZE_MAX) get a specialized kernel, and
+ * only if the shapes are small enough for unrolling to pay off; any other shape uses genericKernel(),
+ * which loops over the hidden neurons.
+ *
+ * The kernels compute the output sum of the network, like BatchEvaluator, with OUTPUT_SIZE == 1.
+ */
+
+#ifndef FIXEDKERNEL_H
+#define FIXEDKERNEL_H
+
+#include "DenseNetwork.h"
+#include "ProblemInfo.h"
+#include "Utils.h"
+
+/* The largest shapes that get specialized kernels */
+#define FIXED_KERNEL_MAX_INPUTS 32
+#define FIXED_KERNEL_MAX_HIDDEN 16
+
+/*
+ * Offsets of the layers in a packed record; the hidden weights go last, as hidden neuron h takes the
+ * Inputs weights starting at HiddenWeights + h * Inputs.
+ */
+template < int Inputs, int MaxHidden >
+struct PackedLayout
+{
+    enum {
+        InputWeights = 0,
+        InputBias = InputWeights + Inputs,
+        HiddenBias = InputBias + Inputs,
+        OutputWeights = HiddenBias + MaxHidden,
+        OutputBias = OutputWeights + MaxHidden,
+        HiddenWeights = OutputBias + 1,
+        Size = HiddenWeights + MaxHidden * Inputs
+    };
+};
+
+typedef PackedLayout< INPUT_SIZE, HIDDEN_SIZE_MAX > NetworkLayout;
+
+/*
+ * Copies a dense network into a record of NetworkLayout::Size weights.
+ */
+inline void packNetwork(const DenseNetwork& dense, double* record)
+{
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        record[NetworkLayout::InputWeights + i] = dense.inputWeights[i];
+        record[NetworkLayout::InputBias + i] = dense.inputBias[i];
+    }
+
+    for (int h = 0; h < HIDDEN_SIZE_MAX; h++) {
+        record[NetworkLayout::HiddenBias + h] = dense.hiddenBias[h];
+        record[NetworkLayout::OutputWeights + h] = dense.outputWeights[h];
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            record[NetworkLayout::HiddenWeights + h * INPUT_SIZE + i] = dense.hiddenWeights[h][i];
+        }
+    }
+
+    record[NetworkLayout::OutputBias] = dense.outputBias;
+}
+
+/*
+ * Unrolled loops over the first N elements, in increasing order, so the sums are rounded as in
+ * genericKernel(): the input layer, and init + the sum of a[i] * b[i].
+ */
+template < int N >
+struct FixedInputLayer
+{
+    static inline void run(const double* x, const double* weights, const double* bias, double* inputs)
+    {
+        FixedInputLayer< N - 1 >::run(x, weights, bias, inputs);
+        inputs[N - 1] = sigmoid(x[N - 1] * weights[N - 1] + bias[N - 1]);
+    }
+};
+
+template <>
+struct FixedInputLayer< 0 >
+{
+    static inline void run(const double *, const double *, const double *, double *)
+    {}
+};
+
+template < int N >
+struct FixedDot
+{
+    static inline double run(const double* a, const double* b, double init)
+    {
+        return FixedDot< N - 1 >::run(a, b, init) + a[N - 1] * b[N - 1];
+    }
+};
+
+template <>
+struct FixedDot< 0 >
+{
+    static inline double run(const double *, const double *, double init)
+    {
+        return init;
+    }
+};
+
+/*
+ * The output sum over the first H hidden neurons, starting from init.
+ */
+template < int Inputs, int MaxHidden, int H >
+struct FixedHiddenLayer
+{
+    typedef PackedLayout< Inputs, MaxHidden > Layout;
+
+    static inline double run(const double* record, const double* inputs, double init)
+    {
+        double zh = FixedDot< Inputs >::run(record + Layout::HiddenWeights + (H - 1) * Inputs, inputs,
+                                            record[Layout::HiddenBias + H - 1]);
+
+        return FixedHiddenLayer< Inputs, MaxHidden, H - 1 >::run(record, inputs, init)
+               + record[Layout::OutputWeights + H - 1] * sigmoid(zh);
+    }
+};
+
+template < int Inputs, int MaxHidden >
+struct FixedHiddenLayer< Inputs, MaxHidden, 0 >
+{
+    static inline double run(const double *, const double *, double init)
+    {
+        return init;
+    }
+};
+
+/*
+ * The output sum of a network with exactly Hidden hidden neurons, packed with PackedLayout< Inputs,
+ * MaxHidden >. The hidden count argument is there to share the signature of genericKernel().
+ */
+template < int Inputs, int MaxHidden, int Hidden >
+struct FixedKernel
+{
+    typedef PackedLayout< Inputs, MaxHidden > Layout;
+
+    static double output(const double* record, int, const double* x)
+    {
+        double inputs[Inputs];
+        FixedInputLayer< Inputs >::run(x, record + Layout::InputWeights, record + Layout::InputBias, inputs);
+
+        return FixedHiddenLayer< Inputs, MaxHidden, Hidden >::run(record, inputs, record[Layout::OutputBias]);
+    }
+};
+
+/*
+ * A kernel takes a packed record, the hidden count of its network and an input vector, and returns
+ * the output sum.
+ */
+typedef double (*PackedKernel)(const double *, int, const double *);
+
+double genericKernel(const double* record, int hiddenCount, const double* x);
+
+/*
+ * The fastest kernel for networks with the given number of hidden neurons.
+ */
+PackedKernel packedKernel(int hiddenCount);
+
+#endif
@@ -0,0 +1,165 @@
+#include "Instrumentation.h"
+
+#include <QMutexLocker>
+#include <cstdio>
+
+/*
+ * The instance is built with its holder, so that Q_GLOBAL_STATIC makes the first use thread-safe.
+ */
+class InstrumentationHelper
+{
+public:
+    InstrumentationHelper()
+        : q(new Instrumentation)
+    {}
+    
+    virtual ~InstrumentationHelper()
+    {
+        delete q;
+    }
+    
+    Instrumentation* q;
+};
+
+Q_GLOBAL_STATIC(InstrumentationHelper, s_instrumentation);
+
+Instrumentation::Instrumentation()
+    : m_epoch(0)
+{
+    m_output.open(stderr, QIODevice::WriteOnly);
+    
+    for (int i = 0; i < PhaseCount; i++) {
+        m_phaseTimes[i] = 0;
+    }
+}
+
+Instrumentation::~Instrumentation()
+{
+    m_output.close();
+}
+
+Instrumentation* Instrumentation::instance()
+{
+    return s_instrumentation()->q;
+}
+
+void Instrumentation::setOutputFile(const QString& path)
+{
+    m_output.close();
+    m_output.setFileName(path);
+    m_output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+void Instrumentation::beginEpoch(int epoch)
+{
+    m_epoch = epoch;
+    
+    for (int i = 0; i < PhaseCount; i++) {
+        m_phaseTimes[i] = 0;
+    }
+    
+    for (int i = 0; i < CounterCount; i++) {
+        m_counters[i] = 0;
+    }
+    
+    m_footprint = MemoryFootprint();
+    m_epochTimer.start();
+}
+
+/*
+ * One line per epoch, for instance:
+ * {"epoch":3,"epoch_ms":12.5,"phases_ms":{"rprop":8.1,...},"counters":{"forward_passes":10000,...},
+ *  "memory_bytes":{"neurons":...,"total":...}}
+ */
+void Instrumentation::endEpoch()
+{
+    QString line = QString("{\"epoch\":%1,\"epoch_ms\":%2,\"phases_ms\":{")
+                        .arg(m_epoch)
+                        .arg(m_epochTimer.nsecsElapsed() / 1e6);
+    
+    for (int i = 0; i < PhaseCount; i++) {
+        line += QString("%1\"%2\":%3").arg(i > 0 ? "," : "")
+                                      .arg(phaseName((Phase)i))
+                                      .arg(phaseTime((Phase)i) / 1e6);
+    }
+    
+    line += "},\"counters\":{";
+    
+    for (int i = 0; i < CounterCount; i++) {
+        line += QString("%1\"%2\":%3").arg(i > 0 ? "," : "")
+                                      .arg(counterName((Counter)i))
+                                      .arg(counter((Counter)i));
+    }
+    
+    line += "},\"memory_bytes\":" + m_footprint.toJson() + "}";
+    writeLine(line);
+}
+
+void Instrumentation::writeLine(const QString& line)
+{
+    m_output.write( line.toUtf8() );
+    m_output.write("\n", 1);
+    m_output.flush();
+}
+
+void Instrumentation::addTime(Instrumentation::Phase phase, qint64 nsecs)
+{
+    QMutexLocker locker(&m_timeLock);
+    m_phaseTimes[phase] += nsecs;
+}
+
+void Instrumentation::increment(Instrumentation::Counter c, int amount)
+{
+    m_counters[c].fetchAndAddRelaxed(amount);
+}
+
+void Instrumentation::setMemoryFootprint(const MemoryFootprint& footprint)
+{
+    m_footprint = footprint;
+}
+
+qint64 Instrumentation::phaseTime(Instrumentation::Phase phase) const
+{
+    return m_phaseTimes[phase];
+}
+
+int Instrumentation::counter(Instrumentation::Counter c) const
+{
+    return m_counters[c];
+}
+
+Instrumentation::Counter Instrumentation::mutationCounter(MutationOperator op)
+{
+    return (Counter)(RemoveLinkMutations + (op - RemoveLink));
+}
+
+const char* Instrumentation::phaseName(Instrumentation::Phase phase)
+{
+    static const char* names[PhaseCount] = {
+        "rprop", "fitness", "ranking", "sparsity", "breeding", "deallocation"
+    };
+    
+    return names[phase];
+}
+
+const char* Instrumentation::counterName(Instrumentation::Counter c)
+{
+    static const char* names[CounterCount] = {
+        "forward_passes", "link_updates", "remove_link_mutations", "add_link_mutations",
+        "remove_neuron_mutations", "add_neuron_mutations", "weight_mutations",
+        "neuron_allocations", "link_allocations"
+    };
+    
+    return names[c];
+}
+
+ScopedPhaseTimer::ScopedPhaseTimer(Instrumentation::Phase phase)
+    : m_phase(phase)
+{
+    m_timer.start();
+}
+
+ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+    Instrumentation::instance()->addTime(m_phase, m_timer.nsecsElapsed());
+}
@@ -0,0 +1,141 @@
+/*
+ * Low-overhead instrumentation for the training loop: scoped timers for the phases of an epoch and
+ * monotonic counters for the most frequent operations. At the end of every epoch the collected values
+ * are written as a single JSON object on its own line, so the output can be processed line by line.
+ * 
+ * Nothing is compiled in unless NEURAL_INSTRUMENTATION is defined (see ENABLE_INSTRUMENTATION in
+ * CMakeLists.txt): the macros at the bottom of this file expand to nothing otherwise.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QString>
+#include <QFile>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include "Utils.h"
+#include "MemoryFootprint.h"
+
+class Instrumentation
+{
+    /*
+     * Only one instance can be present (see instance())
+     */
+    Q_DISABLE_COPY(Instrumentation)
+    
+public:
+    /*
+     * The phases an epoch is split into.
+     */
+    enum Phase {
+        RpropPhase = 0,
+        FitnessPhase,
+        RankingPhase,
+        SparsityPhase,
+        BreedingPhase,
+        DeallocationPhase,
+        PhaseCount
+    };
+    
+    /*
+     * Monotonic counters, reset at the beginning of each epoch. The mutation counters follow the
+     * order of MutationOperator (see mutationCounter()).
+     */
+    enum Counter {
+        ForwardPasses = 0,
+        LinkUpdates,
+        RemoveLinkMutations,
+        AddLinkMutations,
+        RemoveNeuronMutations,
+        AddNeuronMutations,
+        WeightMutations,
+        NeuronAllocations,
+        LinkAllocations,
+        CounterCount
+    };
+    
+    virtual ~Instrumentation();
+    
+    static Instrumentation* instance();
+    
+    /*
+     * Where the JSON lines are written; by default they go to the standard error.
+     */
+    void setOutputFile(const QString &);
+    
+    /*
+     * Marks the boundaries of an epoch: beginEpoch() resets all timers and counters, endEpoch()
+     * writes them out.
+     */
+    void beginEpoch(int);
+    void endEpoch();
+    
+    void addTime(Phase, qint64 nsecs);
+    void increment(Counter, int amount = 1);
+    
+    /*
+     * Memory taken by the population at the end of the epoch.
+     */
+    void setMemoryFootprint(const MemoryFootprint &);
+    
+    /*
+     * Values collected so far in the current epoch (time in nanoseconds).
+     */
+    qint64 phaseTime(Phase) const;
+    int counter(Counter) const;
+    
+    static Counter mutationCounter(MutationOperator);
+    static const char* phaseName(Phase);
+    static const char* counterName(Counter);
+    
+private:
+    friend class InstrumentationHelper;
+    
+    Instrumentation();
+    
+    void writeLine(const QString &);
+    
+    QFile m_output;
+    QMutex m_timeLock;
+    
+    int m_epoch;
+    QElapsedTimer m_epochTimer;
+    qint64 m_phaseTimes[PhaseCount];
+    QAtomicInt m_counters[CounterCount];
+    MemoryFootprint m_footprint;
+};
+
+/*
+ * Adds the time spent in the enclosing scope to the given phase.
+ */
+class ScopedPhaseTimer
+{
+public:
+    explicit ScopedPhaseTimer(Instrumentation::Phase);
+    ~ScopedPhaseTimer();
+    
+private:
+    Instrumentation::Phase m_phase;
+    QElapsedTimer m_timer;
+};
+
+#ifdef NEURAL_INSTRUMENTATION
+    #define INSTRUMENT_PHASE(phase) ScopedPhaseTimer instrumentPhaseTimer(Instrumentation::phase)
+    #define INSTRUMENT_COUNT(counter, amount) Instrumentation::instance()->increment(Instrumentation::counter, amount)
+    #define INSTRUMENT_MUTATION(op) Instrumentation::instance()->increment(Instrumentation::mutationCounter(op))
+    #define INSTRUMENT_FOOTPRINT(footprint) Instrumentation::instance()->setMemoryFootprint(footprint)
+    #define INSTRUMENT_BEGIN_EPOCH(epoch) Instrumentation::instance()->beginEpoch(epoch)
+    #define INSTRUMENT_END_EPOCH() Instrumentation::instance()->endEpoch()
+#else
+    #define INSTRUMENT_PHASE(phase)
+    #define INSTRUMENT_COUNT(counter, amount)
+    #define INSTRUMENT_MUTATION(op)
+    #define INSTRUMENT_FOOTPRINT(footprint)
+    #define INSTRUMENT_BEGIN_EPOCH(epoch)
+    #define INSTRUMENT_END_EPOCH()
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+#include "IslandModel.h"
+#include "ParetoArchive.h"
+#include "Tracing.h"
+
+#include <QDataStream>
+#include <QMutexLocker>
+
+class IslandThread : public QThread
+{
+public:
+    IslandThread(IslandModel* model, int island)
+        : m_model(model)
+        , m_island(island)
+    {}
+
+protected:
+    virtual void run()
+    {
+        if (TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->setThreadName(QString("island %1").arg(m_island));
+        }
+
+        m_model->runIsland(m_island);
+    }
+
+private:
+    IslandModel* m_model;
+    int m_island;
+};
+
+void GenomeChannel::send(const QByteArray& genome)
+{
+    QMutexLocker locker(&m_lock);
+    m_genomes.append(genome);
+}
+
+QList< QByteArray > GenomeChannel::receiveAll()
+{
+    QMutexLocker locker(&m_lock);
+
+    QList< QByteArray > genomes = m_genomes;
+    m_genomes.clear();
+
+    return genomes;
+}
+
+IslandModel::IslandModel(int islands, int networksPerIsland, int threads, int migrationInterval, int migrants)
+    : m_migrationInterval( qMax(migrationInterval, 1) )
+    , m_migrants(migrants)
+{
+    islands = qMax(islands, 1);
+    int threadsPerIsland = qMax(threads / islands, 1);
+
+    for (int i = 0; i < islands; i++) {
+        m_islands.append( new NetworkEnsemble(networksPerIsland, threadsPerIsland) );
+        m_channels.append( new GenomeChannel );
+    }
+}
+
+IslandModel::~IslandModel()
+{
+    qDeleteAll(m_islands);
+    qDeleteAll(m_channels);
+}
+
+void IslandModel::training(QList< InputSample* >& trainingSamples, QList< InputSample* >& generationTest)
+{
+    m_trainingSamples = trainingSamples;
+    m_generationTest = generationTest;
+
+    QList< IslandThread* > threads;
+
+    for (int i = 0; i < m_islands.size(); i++) {
+        threads.append( new IslandThread(this, i) );
+        threads.last()->start();
+    }
+
+    Q_FOREACH (IslandThread* thread, threads) {
+        thread->wait();
+    }
+
+    qDeleteAll(threads);
+    mergeFronts();
+}
+
+double IslandModel::test(QList< InputSample* >& testSamples)
+{
+    return ensemble()->test(testSamples);
+}
+
+NetworkEnsemble* IslandModel::ensemble()
+{
+    return m_islands.first();
+}
+
+int IslandModel::islandCount() const
+{
+    return m_islands.size();
+}
+
+void IslandModel::runIsland(int island)
+{
+    NetworkEnsemble* ensemble = m_islands[island];
+    ensemble->beginTraining(m_trainingSamples, m_generationTest);
+
+    int epochs = ensemble->configuration().epochs;
+
+    while (ensemble->epoch() < epochs) {
+        ensemble->trainEpoch();
+
+        if (ensemble->epoch() % m_migrationInterval == 0 && ensemble->epoch() < epochs) {
+            migrate(island);
+        }
+    }
+
+    ensemble->endTraining();
+}
+
+/*
+ * Sends copies of some non-dominated networks to the next island, and takes in what the previous one has
+ * sent so far. Genomes that can't be read are dropped.
+ */
+void IslandModel::migrate(int island)
+{
+    TRACE_SPAN_ARG("migration", "island", island);
+
+    NetworkEnsemble* ensemble = m_islands[island];
+    GenomeChannel* next = m_channels[ (island + 1) % m_channels.size() ];
+
+    if (next != m_channels[island]) {
+        Q_FOREACH (Network* net, ensemble->emigrants(m_migrants)) {
+            QByteArray genome;
+            QDataStream stream(&genome, QIODevice::WriteOnly);
+
+            net->save(stream);
+            next->send(genome);
+        }
+    }
+
+    Q_FOREACH (const QByteArray& genome, m_channels[island]->receiveAll()) {
+        QDataStream stream(genome);
+        Network* net = Network::load(stream, 0);
+
+        if (net) {
+            ensemble->immigrate(net);
+        }
+    }
+}
+
+/*
+ * All the islands measured the errors on the same samples, so their fronts can be compared directly.
+ */
+void IslandModel::mergeFronts()
+{
+    QList< Network* > networks;
+    ParetoArchive archive;
+
+    Q_FOREACH (NetworkEnsemble* ensemble, m_islands) {
+        networks += ensemble->takeNetworks();
+    }
+
+    Q_FOREACH (Network* net, networks) {
+        archive.insert(net);
+    }
+
+    QList< Network* > front = archive.front(0);
+
+    Q_FOREACH (Network* net, networks) {
+        if (!front.contains(net)) {
+            delete net;
+        }
+    }
+
+    ensemble()->setNetworks(front);
+}
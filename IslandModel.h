@@ -0,0 +1,82 @@
+/*
+ * Island model for the genetic algorithm: several populations are trained at the same time, each one by
+ * its own NetworkEnsemble in its own thread, with a share of the worker threads. Every few epochs each
+ * island sends copies of some of its non-dominated networks to the next one, in a ring, and takes in
+ * the networks sent to it; at the end the first Pareto fronts of all the islands are merged into one.
+ *
+ * Networks travel as serialized genomes (see Network::save()) through GenomeChannel mailboxes, so the
+ * islands never share a network. Islands don't wait for each other: an island takes whatever has
+ * arrived when it migrates.
+ */
+
+#ifndef ISLANDMODEL_H
+#define ISLANDMODEL_H
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QByteArray>
+
+#include "Ensemble.h"
+
+/*
+ * A mailbox of serialized genomes; any thread can send, and the owner takes all of them at once.
+ */
+class GenomeChannel
+{
+public:
+    void send(const QByteArray &);
+    QList< QByteArray > receiveAll();
+
+private:
+    QMutex m_lock;
+    QList< QByteArray > m_genomes;
+};
+
+class IslandModel
+{
+    Q_DISABLE_COPY(IslandModel)
+
+public:
+    /*
+     * The parameters are the number of islands, the networks in each island, the total number of worker
+     * threads, how many epochs pass between two migrations, and how many networks each island sends.
+     */
+    explicit IslandModel(int islands, int networksPerIsland, int threads = QThread::idealThreadCount(),
+                         int migrationInterval = 10, int migrants = 2);
+    virtual ~IslandModel();
+
+    /*
+     * Same as NetworkEnsemble::training(), on every island.
+     */
+    void training(QList< InputSample* >&, QList< InputSample* > &);
+
+    /*
+     * Tests the merged front, as NetworkEnsemble::test().
+     */
+    double test(QList< InputSample* >&);
+
+    /*
+     * After the training, the ensemble holding the merged front.
+     */
+    NetworkEnsemble* ensemble();
+
+    int islandCount() const;
+
+private:
+    friend class IslandThread;
+
+    void runIsland(int);
+    void migrate(int);
+    void mergeFronts();
+
+    QList< NetworkEnsemble* > m_islands;
+    QList< GenomeChannel* > m_channels; /* the inbox of each island */
+    int m_migrationInterval;
+    int m_migrants;
+
+    QList< InputSample* > m_trainingSamples;
+    QList< InputSample* > m_generationTest;
+};
+
+#endif
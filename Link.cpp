@@ -5,16 +5,19 @@
 #include "Link.h"
 #include "Neuron.h"
 #include "ProblemInfo.h"
+#include "Instrumentation.h"
 
-Link::Link(double weight, Neuron* prev, Neuron* succ)
+Link::Link(double weight, Neuron* prev, Neuron* succ, double delta)
     : m_weight(weight)
     , m_output(0.0)
     , m_gradient(0.0)
     , m_prevGradient(0.0)
-    , m_delta(INITIAL_STEP)
+    , m_delta(delta)
     , m_next(succ)
     , m_prev(prev)
-{}
+{
+    INSTRUMENT_COUNT(LinkAllocations, 1);
+}
 
 Link::~Link()
 {}
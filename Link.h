@@ -5,12 +5,17 @@
 #ifndef LINK_H
 #define LINK_H
 
+#include "ProblemInfo.h"
+
 class Neuron;
 
 class Link
 {
 public:
-    explicit Link(double, Neuron *, Neuron *);
+    /*
+     * The parameters are the weight, the predecessor and the successor, and the first RPROP step.
+     */
+    explicit Link(double, Neuron *, Neuron *, double delta = INITIAL_STEP);
     virtual ~Link();
     
     /*
@@ -8,6 +8,7 @@
 
 #include "LinkMatrix.h"
 #include "Neuron.h"
+#include "MemoryFootprint.h"
 
 #include <QtCore/QDebug>
 
@@ -39,6 +40,11 @@ int LinkMatrix::complexity() const
     return m_links.size();
 }
 
+qint64 LinkMatrix::memoryFootprint() const
+{
+    return MemoryFootprint::map( m_links.size(), sizeof(QPair<int, int>) + sizeof(Link*) );
+}
+
 void LinkMatrix::removeLink(int n1, int n2)
 {
     m_links.remove( qMakePair<int, int>(n1, n2) );
@@ -49,48 +55,24 @@ void LinkMatrix::addLink(int n1, int n2, Link* link)
     m_links.insert( qMakePair<int, int>(n1, n2), link );
 }
 
-void LinkMatrix::removeAllLinks(int neuron, int maxId, const QHash< int, Neuron* >& neurons)
+/*
+ * Only the connections of the neuron are visited, so this costs O(degree) map operations.
+ */
+void LinkMatrix::removeAllLinks(Neuron* neuron)
 {
-    for (int i = -1; i <= maxId; i++) {
-        if (i == neuron) {
-            continue;
-        }
-        
-        Link* linkOut = link(neuron, i);
-        Link* linkIn = link(i, neuron);
+    Q_FOREACH (Link* linkOut, neuron->outConnections()) {
+        linkOut->successor()->removeInConnection(linkOut);
+        neuron->removeOutConnection(linkOut);
+        m_links.remove( qMakePair<int, int>(neuron->id(), linkOut->successor()->id()) );
         
-        if (linkOut) {
-            neurons[i]->removeInConnection(linkOut);
-            m_links.remove( qMakePair<int, int>(neuron, i) );
-            
-            delete linkOut;
-            linkOut = 0;
-        }
-        
-        if (linkIn) {
-            neurons[i]->removeOutConnection(linkIn);
-            m_links.remove( qMakePair<int, int>(i, neuron) );
-            
-            delete linkIn;
-            linkIn = 0;
-        }
+        delete linkOut;
     }
-}
-
-void LinkMatrix::changeId(int oldId, int newId)
-{
-    for (int i = -1; i < oldId; i++) {
-        Link* linkIn = link(i, oldId);
-        Link* linkOut = link(oldId, i);
-        
-        if (linkOut) {
-            m_links.remove( qMakePair<int, int>(oldId, i) );
-            m_links.insert( qMakePair<int, int>(newId, i), linkOut );
-        }
+    
+    Q_FOREACH (Link* linkIn, neuron->inConnections()) {
+        linkIn->predecessor()->removeOutConnection(linkIn);
+        neuron->removeInConnection(linkIn);
+        m_links.remove( qMakePair<int, int>(linkIn->predecessor()->id(), neuron->id()) );
         
-        if (linkIn) {
-            m_links.remove( qMakePair<int, int>(i, oldId) );
-            m_links.insert( qMakePair<int, int>(i, newId), linkIn );
-        }
+        delete linkIn;
     }
 }
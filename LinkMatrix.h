@@ -11,10 +11,11 @@
 
 #include <QMap>
 #include <QPair>
-#include <QHash>
 
 #include "Link.h"
 
+class Neuron;
+
 class LinkMatrix
 {
 public:
@@ -42,6 +43,11 @@ public:
      */
     int complexity() const;
     
+    /*
+     * Bytes taken by the index (the links themselves are not included).
+     */
+    qint64 memoryFootprint() const;
+    
     /*
      * Add a new link between two neurons.
      */
@@ -53,15 +59,10 @@ public:
     void removeLink(int, int);
     
     /*
-     * Remove all links going to or coming from @neuron. @maxId is the maximum neuron ID currently active,
-     * while the @neurons hash is needed to remove the link from inConnections or outConnections lists.
-     */
-    void removeAllLinks(int neuron, int maxId, const QHash< int, Neuron* >& neurons);
-    
-    /*
-     * This must be called when changing the ID of a neuron: updates all the links concerning it.
+     * Remove and delete all links going to or coming from @neuron, also removing them from the
+     * connection lists of the neurons on the other side.
      */
-    void changeId(int oldId, int newId);
+    void removeAllLinks(Neuron* neuron);
     
 private:
     QMap< QPair<int, int>, Link* > m_links;
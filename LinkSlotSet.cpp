@@ -0,0 +1,79 @@
+#include "LinkSlotSet.h"
+#include "MemoryFootprint.h"
+
+LinkSlotSet::LinkSlotSet()
+{}
+
+LinkSlotSet::~LinkSlotSet()
+{}
+
+void LinkSlotSet::insert(int in, int out)
+{
+    QPair< int, int > pair = qMakePair<int, int>(in, out);
+    
+    if (m_positions.contains(pair)) {
+        return;
+    }
+    
+    m_positions.insert(pair, m_pairs.size());
+    m_pairs.append(pair);
+}
+
+void LinkSlotSet::remove(int in, int out)
+{
+    QPair< int, int > pair = qMakePair<int, int>(in, out);
+    int position = m_positions.value(pair, -1);
+    
+    if (position < 0) {
+        return;
+    }
+    
+    QPair< int, int > last = m_pairs.last();
+    m_pairs[position] = last;
+    m_positions.insert(last, position);
+    
+    m_pairs.removeLast();
+    m_positions.remove(pair);
+}
+
+bool LinkSlotSet::contains(int in, int out) const
+{
+    return m_positions.contains( qMakePair<int, int>(in, out) );
+}
+
+QPair< int, int > LinkSlotSet::at(int position) const
+{
+    return m_pairs[position];
+}
+
+int LinkSlotSet::size() const
+{
+    return m_pairs.size();
+}
+
+void LinkSlotSet::clear()
+{
+    m_pairs.clear();
+    m_positions.clear();
+}
+
+bool LinkSlotSet::isConsistent() const
+{
+    if (m_positions.size() != m_pairs.size()) {
+        return false;
+    }
+    
+    for (int position = 0; position < m_pairs.size(); position++) {
+        if (m_positions.value(m_pairs[position], -1) != position) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+qint64 LinkSlotSet::memoryFootprint() const
+{
+    return MemoryFootprint::allocation( m_pairs.capacity() * sizeof(QPair<int, int>) )
+            + MemoryFootprint::hash( m_positions.size(), sizeof(QPair<int, int>) + sizeof(int) );
+}
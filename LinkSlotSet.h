@@ -0,0 +1,49 @@
+/*
+ * A set of (predecessor, successor) neuron ID pairs, supporting insertion, removal and uniform random
+ * choice in constant time. The pairs are kept in a vector, while a hash gives the position of each pair;
+ * on removal the last pair takes the place of the removed one.
+ * 
+ * Networks use it to keep track of the links that exist and of those that could be added.
+ */
+
+#ifndef LINKSLOTSET_H
+#define LINKSLOTSET_H
+
+#include <QPair>
+#include <QHash>
+#include <QVector>
+
+class LinkSlotSet
+{
+public:
+    explicit LinkSlotSet();
+    virtual ~LinkSlotSet();
+    
+    /*
+     * Adding a pair already in the set, or removing one not in it, does nothing.
+     */
+    void insert(int, int);
+    void remove(int, int);
+    bool contains(int, int) const;
+    
+    /*
+     * Returns the pair in a given position; positions change when pairs are removed.
+     */
+    QPair< int, int > at(int) const;
+    
+    int size() const;
+    void clear();
+    
+    /*
+     * True if the vector and the hash hold the same pairs, each at its recorded position.
+     */
+    bool isConsistent() const;
+    
+    qint64 memoryFootprint() const;
+    
+private:
+    QVector< QPair< int, int > > m_pairs;
+    QHash< QPair< int, int >, int > m_positions;
+};
+
+#endif
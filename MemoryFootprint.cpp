@@ -0,0 +1,84 @@
+#include "MemoryFootprint.h"
+
+/*
+ * Bookkeeping added by the allocator to each block (glibc keeps a size word, and rounds the
+ * block up to a multiple of two words).
+ */
+static const qint64 ALLOCATION_HEADER = sizeof(void*);
+static const qint64 ALLOCATION_ALIGN = 2 * sizeof(void*);
+
+/*
+ * Header of the shared data of QList and QHash (reference count, sizes, flags).
+ */
+static const qint64 CONTAINER_HEADER = 4 * sizeof(int) + sizeof(void*);
+
+MemoryFootprint::MemoryFootprint()
+    : neurons(0)
+    , links(0)
+    , index(0)
+    , samples(0)
+{}
+
+qint64 MemoryFootprint::total() const
+{
+    return neurons + links + index + samples;
+}
+
+QString MemoryFootprint::toJson() const
+{
+    return QString("{\"neurons\":%1,\"links\":%2,\"index\":%3,\"samples\":%4,\"total\":%5}")
+                .arg(neurons)
+                .arg(links)
+                .arg(index)
+                .arg(samples)
+                .arg(total());
+}
+
+MemoryFootprint& MemoryFootprint::operator+=(const MemoryFootprint& other)
+{
+    neurons += other.neurons;
+    links += other.links;
+    index += other.index;
+    samples += other.samples;
+    
+    return *this;
+}
+
+qint64 MemoryFootprint::allocation(qint64 size)
+{
+    qint64 block = size + ALLOCATION_HEADER;
+    return ((block + ALLOCATION_ALIGN - 1) / ALLOCATION_ALIGN) * ALLOCATION_ALIGN;
+}
+
+/*
+ * An empty QList shares a static header, otherwise the header and the array of pointers are allocated
+ * together.
+ */
+qint64 MemoryFootprint::pointerList(int size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    
+    return allocation(CONTAINER_HEADER + size * sizeof(void*));
+}
+
+/*
+ * QMap is a skip-list: each node holds the payload, a backward pointer and on average 1.33 forward
+ * pointers (the probability of a node growing a new level is 1/4).
+ */
+qint64 MemoryFootprint::map(int size, qint64 payload)
+{
+    qint64 node = payload + sizeof(void*) + (4 * sizeof(void*)) / 3;
+    return allocation(CONTAINER_HEADER) + size * allocation(node);
+}
+
+/*
+ * QHash nodes hold the payload, the next pointer and the hash value, while the bucket array has
+ * (about) one pointer per entry.
+ */
+qint64 MemoryFootprint::hash(int size, qint64 payload)
+{
+    qint64 node = payload + sizeof(void*) + sizeof(uint);
+    return allocation(CONTAINER_HEADER + size * sizeof(void*)) + size * allocation(node);
+}
@@ -0,0 +1,66 @@
+/*
+ * Memory accounting for networks, populations and datasets.
+ * 
+ * The sizes of our own objects are exact, while the overhead of the Qt containers and of the allocator
+ * is estimated from their layout (see the functions below): the figures are meant to compare
+ * configurations against a memory budget, not to match the allocator byte by byte.
+ */
+
+#ifndef MEMORYFOOTPRINT_H
+#define MEMORYFOOTPRINT_H
+
+#include <QString>
+
+class MemoryFootprint
+{
+public:
+    MemoryFootprint();
+    
+    /*
+     * Neurons, including their connection lists.
+     */
+    qint64 neurons;
+    
+    /*
+     * Links, each one being a separate allocation.
+     */
+    qint64 links;
+    
+    /*
+     * Index structures: the neuron hash, the layer lists and the link matrix.
+     */
+    qint64 index;
+    
+    /*
+     * Input samples (only for datasets).
+     */
+    qint64 samples;
+    
+    qint64 total() const;
+    
+    /*
+     * A JSON object with all the fields above, in bytes.
+     */
+    QString toJson() const;
+    
+    MemoryFootprint& operator+=(const MemoryFootprint &);
+    
+    /*
+     * Estimated bytes taken by a single heap allocation of the given size.
+     */
+    static qint64 allocation(qint64 size);
+    
+    /*
+     * Estimated bytes taken by a QList of pointers holding @size elements.
+     */
+    static qint64 pointerList(int size);
+    
+    /*
+     * Estimated bytes taken by a QMap or QHash with @size entries, where each key-value pair
+     * takes @payload bytes.
+     */
+    static qint64 map(int size, qint64 payload);
+    static qint64 hash(int size, qint64 payload);
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "Network.h"
 #include "Utils.h"
 #include "ProblemInfo.h"
+#include "Instrumentation.h"
 #include <stdlib.h>
 
 #include <QtCore/QPair>
@@ -8,22 +9,30 @@
 #include <iostream>
 #include <cmath>
 
-Network::Network(int id)
+Network::Network(int id, const SharedConfiguration& config)
     : m_id(id)
-    , maxNeuronId(0)
     , m_averageError(0.0)
-    , m_sparsity(0.0)
+    , m_voteWeight(1)
+    , m_config(config)
 {
-    int numNeurons = INPUT_SIZE + OUTPUT_SIZE + HIDDEN_SIZE;
+    Q_ASSERT (m_config->isValid());
+    
+    /*
+     * The configuration is checked by whoever makes it; the bound only guards the fixed-size buffers.
+     */
+    int numNeurons = INPUT_SIZE + OUTPUT_SIZE + qBound(1, m_config->hiddenSize, HIDDEN_SIZE_MAX);
     
     /*
      * This is a fake neuron to represent the predecessor neuron for biases link
-     * (see below). The layer is meaningless, while the ID cannot be taken by any
-     * other neuron in the network.
+     * (see below). The layer is meaningless; being the first one, it takes the
+     * BIAS_NEURON_ID slot.
      */
-    Neuron* dummy = new SigmoidNeuron(-1, Neuron::InputLayer);
-    m_neurons.insert(-1, dummy);
+    Neuron* dummy = new SigmoidNeuron(m_neurons.nextId(), Neuron::InputLayer);
+    m_neurons.insert(dummy);
     
+    /*
+     * The store gives out IDs in order, so here neuron i gets ID i.
+     */
     for (int i = 1; i <= numNeurons; i++) {
         Neuron::Layer layer = Neuron::HiddenLayer;
         
@@ -45,7 +54,7 @@ Network::Network(int id)
             createBiasLink(dummy, neuron);
             
             m_inputNeurons.append(neuron);
-            m_neurons.insert(i, neuron);
+            m_neurons.insert(neuron);
             
             continue;
         }
@@ -64,7 +73,7 @@ Network::Network(int id)
         }
         
         createBiasLink(dummy, neuron);
-        m_neurons.insert(i, neuron);
+        m_neurons.insert(neuron);
         
         if (layer == Neuron::OutputLayer) {
             m_outputNeurons.append(neuron);
@@ -73,8 +82,6 @@ Network::Network(int id)
         }
     }
     
-    maxNeuronId = numNeurons;
-    
     /*
      * No connections between hidden neurons are allowed
      */
@@ -89,6 +96,10 @@ Network::Network(int id)
             createRandomLink(i, j);
         }
     }
+    
+    Q_FOREACH (Neuron* hidden, m_hiddenNeurons) {
+        addLinkSlots(hidden);
+    }
 }
 
 /*
@@ -96,65 +107,241 @@ Network::Network(int id)
  */
 Network::Network(const Network* other, int id)
     : m_id(id)
-    , maxNeuronId(0)
-    , m_sparsity(0)
+    , m_averageError(other->m_averageError)
+    , m_voteWeight(other->m_voteWeight)
+    , m_config(other->m_config)
 {    
-    Q_FOREACH (Neuron* otherNeuron, other->m_neurons.values()) {
-        int neuronId = otherNeuron->id();
+    /*
+     * Neurons keep their IDs (and the free slots stay the same), so the handles taken on the other
+     * network are valid on this one too. The layer lists are copied in the same order.
+     */
+    m_neurons.copyLayout(other->m_neurons);
+    m_neurons.place( new SigmoidNeuron(BIAS_NEURON_ID, Neuron::InputLayer) );
+    
+    Q_FOREACH (Neuron* otherNeuron, other->m_inputNeurons) {
+        Neuron* newNeuron = new SigmoidNeuron(otherNeuron->id(), otherNeuron);
+        newNeuron->addInConnection( new Link( 1.0f, 0, newNeuron) );
         
-        if (neuronId == -1) {
-            m_neurons.insert(-1, new SigmoidNeuron(-1, Neuron::InputLayer));
-            continue;
+        m_inputNeurons.append(newNeuron);
+        m_neurons.place(newNeuron);
+    }
+    
+    Q_FOREACH (Neuron* otherNeuron, other->m_hiddenNeurons) {
+        Neuron* newNeuron = new SigmoidNeuron(otherNeuron->id(), otherNeuron);
+        
+        m_hiddenNeurons.append(newNeuron);
+        m_neurons.place(newNeuron);
+    }
+    
+    Q_FOREACH (Neuron* otherNeuron, other->m_outputNeurons) {
+        Neuron* newNeuron = new TangentNeuron(otherNeuron->id(), otherNeuron);
+        
+        m_outputNeurons.append(newNeuron);
+        m_neurons.place(newNeuron);
+    }
+    
+    Q_FOREACH (Link* link, other->m_connectivity.links()) {
+        int in = link->predecessor()->id();
+        int out = link->successor()->id();
+        
+        Link* newLink = new Link(link->weight(), m_neurons.at(in), m_neurons.at(out), m_config->initialStep);
+        newLink->setOutput( link->output() );
+
+        m_neurons.at(in)->addOutConnection(newLink);
+        m_neurons.at(out)->addInConnection(newLink);
+        m_connectivity.addLink(in, out, newLink);
+    }
+    
+    for (int i = 0; i < LinkLayersCount; i++) {
+        m_existingLinks[i] = other->m_existingLinks[i];
+        m_freeLinks[i] = other->m_freeLinks[i];
+    }
+}
+
+Network::Network()
+    : m_id(0)
+    , m_lastOutput(0.0)
+    , m_lastError(0.0)
+    , m_oldError(0.0)
+    , m_averageError(0.0)
+    , m_voteWeight(1)
+{}
+
+/*
+ * Increased whenever the format written by save() changes; load() only reads the current one.
+ */
+#define GENOME_VERSION 1
+
+/*
+ * The same things the copy constructor copies, in the same order, except the link slots.
+ */
+void Network::save(QDataStream& stream) const
+{
+    stream << (quint32)GENOME_VERSION;
+    stream << m_averageError;
+    stream << (qint32)m_voteWeight;
+    
+    m_neurons.writeLayout(stream);
+    
+    const QList< Neuron* >* layers[] = { &m_inputNeurons, &m_hiddenNeurons, &m_outputNeurons };
+    
+    for (int l = 0; l < 3; l++) {
+        stream << (qint32)layers[l]->size();
+        
+        Q_FOREACH (Neuron* neuron, *layers[l]) {
+            stream << (qint32)neuron->id();
         }
+    }
+    
+    QList< Link* > links = m_connectivity.links();
+    stream << (qint32)links.size();
+    
+    Q_FOREACH (Link* link, links) {
+        stream << (qint32)link->predecessor()->id() << (qint32)link->successor()->id();
+        stream << link->weight() << link->output();
+    }
+}
+
+Network* Network::load(QDataStream& stream, int id, const SharedConfiguration& config)
+{
+    quint32 version;
+    stream >> version;
+    
+    if (stream.status() != QDataStream::Ok || version != GENOME_VERSION) {
+        return NULL;
+    }
+    
+    Network* net = new Network();
+    net->m_id = id;
+    net->m_config = config;
+    
+    qint32 voteWeight;
+    stream >> net->m_averageError >> voteWeight;
+    
+    if (stream.status() != QDataStream::Ok || voteWeight < 1) {
+        delete net;
+        return NULL;
+    }
+    
+    net->m_voteWeight = voteWeight;
+    
+    if (!net->m_neurons.readLayout(stream) || net->m_neurons.capacity() <= BIAS_NEURON_ID) {
+        delete net;
+        return NULL;
+    }
+    
+    net->m_neurons.place( new SigmoidNeuron(BIAS_NEURON_ID, Neuron::InputLayer) );
+    
+    /*
+     * The evaluation paths index fixed-size arrays by position in the layers, and the input and output
+     * layers never change.
+     */
+    QList< Neuron* >* layers[] = { &net->m_inputNeurons, &net->m_hiddenNeurons, &net->m_outputNeurons };
+    const int layerMinimum[] = { INPUT_SIZE, 0, OUTPUT_SIZE };
+    const int layerMaximum[] = { INPUT_SIZE, HIDDEN_SIZE_MAX, OUTPUT_SIZE };
+    
+    for (int l = 0; l < 3; l++) {
+        qint32 count;
+        stream >> count;
         
-        switch ( otherNeuron->layer() ) {
-            case Neuron::InputLayer: {
-                Neuron* newNeuron = new SigmoidNeuron(neuronId, otherNeuron);
-                newNeuron->addInConnection( new Link( 1.0f, 0, newNeuron) );
-                
-                m_inputNeurons.append(newNeuron);
-                m_neurons.insert(neuronId, newNeuron);
-                break;
-            }
+        if (stream.status() != QDataStream::Ok || count < layerMinimum[l] || count > layerMaximum[l]) {
+            delete net;
+            return NULL;
+        }
+        
+        for (int n = 0; n < count; n++) {
+            qint32 neuronId;
+            stream >> neuronId;
             
-            case Neuron::HiddenLayer: {
-                Neuron* newNeuron = new SigmoidNeuron(neuronId, otherNeuron);
-                
-                m_neurons.insert(neuronId, newNeuron);
-                m_hiddenNeurons.append(newNeuron);
-                break;
+            if (neuronId < 0 || neuronId >= net->m_neurons.capacity() || net->m_neurons.at(neuronId)) {
+                delete net;
+                return NULL;
             }
             
-            case Neuron::OutputLayer: {
-                Neuron* newNeuron = new TangentNeuron(neuronId, otherNeuron);
-                
-                m_neurons.insert(neuronId, newNeuron);
-                m_outputNeurons.append(newNeuron);
-                break;
+            Neuron* neuron = NULL;
+            
+            if (l == 0) {
+                neuron = new SigmoidNeuron(neuronId, Neuron::InputLayer);
+                neuron->addInConnection( new Link(1.0f, 0, neuron) );
+            } else if (l == 1) {
+                neuron = new SigmoidNeuron(neuronId, Neuron::HiddenLayer);
+            } else {
+                neuron = new TangentNeuron(neuronId, Neuron::OutputLayer);
             }
+            
+            layers[l]->append(neuron);
+            net->m_neurons.place(neuron);
         }
     }
     
-    maxNeuronId = other->maxNeuronId;
+    qint32 linkCount;
+    stream >> linkCount;
     
-    Q_FOREACH (Link* link, other->m_connectivity.links()) {
-        int in = link->predecessor()->id();
-        int out = link->successor()->id();
+    if (stream.status() != QDataStream::Ok || linkCount < 0 || linkCount > MAX_NEURONS * MAX_NEURONS) {
+        delete net;
+        return NULL;
+    }
+    
+    for (int i = 0; i < linkCount; i++) {
+        qint32 in, out;
+        double weight, output;
+        stream >> in >> out >> weight >> output;
         
-        Link* newLink = new Link(link->weight(), m_neurons[in], m_neurons[out]);
-        newLink->setOutput( link->output() );
+        Neuron* predecessor = (in >= 0 && in < net->m_neurons.capacity()) ? net->m_neurons.at(in) : NULL;
+        Neuron* successor = (out >= 0 && out < net->m_neurons.capacity()) ? net->m_neurons.at(out) : NULL;
+        
+        if (stream.status() != QDataStream::Ok || !predecessor || !successor || net->m_connectivity.link(in, out)
+            || !isAllowedLink(predecessor, successor)) {
+            delete net;
+            return NULL;
+        }
+        
+        Link* link = new Link(weight, predecessor, successor, net->m_config->initialStep);
+        link->setOutput(output);
+        
+        predecessor->addOutConnection(link);
+        successor->addInConnection(link);
+        net->m_connectivity.addLink(in, out, link);
+    }
+    
+    /*
+     * The link slots aren't saved: they are rebuilt from the links, as the constructor does.
+     */
+    Q_FOREACH (Neuron* hidden, net->m_hiddenNeurons) {
+        net->addLinkSlots(hidden);
+    }
+    
+    if (stream.status() != QDataStream::Ok || !net->isConsistent()) {
+        delete net;
+        return NULL;
+    }
+    
+    return net;
+}
 
-        m_neurons[in]->addOutConnection(newLink);
-        m_neurons[out]->addInConnection(newLink);
-        m_connectivity.addLink(in, out, newLink);
+/*
+ * Biases go to any neuron; the other links go from input to hidden neurons and from hidden to output
+ * neurons.
+ */
+bool Network::isAllowedLink(const Neuron* predecessor, const Neuron* successor)
+{
+    if (successor->id() == BIAS_NEURON_ID) {
+        return false;
+    }
+    
+    if (predecessor->id() == BIAS_NEURON_ID) {
+        return true;
     }
+    
+    return (predecessor->layer() == Neuron::InputLayer && successor->layer() == Neuron::HiddenLayer)
+           || (predecessor->layer() == Neuron::HiddenLayer && successor->layer() == Neuron::OutputLayer);
 }
 
+/*
+ * Neurons are deleted by the store, links by the link matrix.
+ */
 Network::~Network()
-{    
-    qDeleteAll(m_neurons);
-    m_neurons.clear();
-}
+{}
 
 /*
  * Creates a link between i and j with 50% probability.
@@ -164,9 +351,9 @@ void Network::createRandomLink(int i, int j)
     double r = randomDouble(0.0, 1.0);
     
     if (r <= 0.5) {
-        Link* link = new Link(randomWeight(), m_neurons[i], m_neurons[j]);
-        m_neurons[i]->addOutConnection(link);
-        m_neurons[j]->addInConnection(link);
+        Link* link = new Link(randomWeight(), m_neurons.at(i), m_neurons.at(j), m_config->initialStep);
+        m_neurons.at(i)->addOutConnection(link);
+        m_neurons.at(j)->addInConnection(link);
         
         m_connectivity.addLink(i, j, link);
     }
@@ -177,10 +364,10 @@ void Network::createRandomLink(int i, int j)
  */
 void Network::createBiasLink(Neuron* dummy, Neuron* neuron)
 {
-    Link* biasLink = new Link(randomBias(), dummy, neuron);
+    Link* biasLink = new Link(randomBias(), dummy, neuron, m_config->initialStep);
     biasLink->setOutput(1.0);
     neuron->addInConnection(biasLink);
-    m_connectivity.addLink(-1, neuron->id(), biasLink);
+    m_connectivity.addLink(dummy->id(), neuron->id(), biasLink);
 }
 
 double Network::randomBias()
@@ -195,7 +382,17 @@ double Network::randomWeight()
 
 Neuron* Network::getNeuron(int id) const
 {
-    return m_neurons[id];
+    return m_neurons.at(id);
+}
+
+Neuron* Network::getNeuron(const NeuronHandle& handle) const
+{
+    return m_neurons.get(handle);
+}
+
+NeuronHandle Network::neuronHandle(int id) const
+{
+    return m_neurons.handle(id);
 }
 
 Link* Network::getLink(int n1, int n2) const
@@ -220,6 +417,13 @@ int Network::id() const
 
 void Network::applyInput(double input[], int expectedClass)
 {
+    applyTarget(input, (expectedClass == 0) ? -1 : 1);
+}
+
+void Network::applyTarget(double input[], double target)
+{
+    INSTRUMENT_COUNT(ForwardPasses, 1);
+    
     for (int i = 0; i < m_inputNeurons.size(); i++) {        
         Neuron* neuron = m_inputNeurons[i];
         Link* inLink = neuron->inConnections().first();
@@ -237,15 +441,127 @@ void Network::applyInput(double input[], int expectedClass)
     m_lastOutput = (outNeuron->output() > 0.0) ? 1.0 : 0.0;
     
     m_oldError = m_lastError;
-    m_lastError = (expectedClass == m_lastOutput) ? 0.0 : 1.0; /* simple classification error */
+    m_lastError = (((target > 0.0) ? 1.0 : 0.0) == m_lastOutput) ? 0.0 : 1.0; /* simple classification error */
     
-    computeGradients(expectedClass);
+    computeGradients(target);
 }
 
-void Network::computeGradients(int expectedClass)
+int Network::predict(const double input[]) const
 {
-    double target = (expectedClass == 0) ? -1 : 1;
+    return (predictOutput(input) > 0.0) ? 1 : 0;
+}
+
+/*
+ * Neuron outputs are kept in a local array indexed by neuron ID, instead of being stored on the links
+ * as in applyInput(). The sums are done in the same order as Neuron::computeOutput(), so the result is
+ * exactly the same.
+ * 
+ * NOTE: applyInput() writes the input value on the first incoming link of each input neuron, which is the
+ * last one added, i.e. the bias link; the fake input link is never written and always outputs 0. This does
+ * the same, so that predictions match what the network was trained on.
+ */
+double Network::predictOutput(const double input[]) const
+{
+    INSTRUMENT_COUNT(ForwardPasses, 1);
+    
+    double outputs[MAX_NEURONS];
+    outputs[BIAS_NEURON_ID] = 1.0;
+    
+    for (int i = 0; i < m_inputNeurons.size(); i++) {
+        Neuron* neuron = m_inputNeurons[i];
+        QList< Link* > inLinks = neuron->inConnections();
+        double z = 0.0;
+        
+        for (int j = 0; j < inLinks.size(); j++) {
+            double value = (j == 0) ? input[i] : inLinks[j]->output();
+            z += (value * inLinks[j]->weight());
+        }
+        
+        outputs[neuron->id()] = neuron->activation(z);
+    }
+    
+    Q_FOREACH (Neuron* hidden, m_hiddenNeurons) {
+        double z = 0.0;
+        
+        Q_FOREACH (Link* in, hidden->inConnections()) {
+            z += (outputs[in->predecessor()->id()] * in->weight());
+        }
+        
+        outputs[hidden->id()] = hidden->activation(z);
+    }
+    
+    Neuron* outNeuron = m_outputNeurons.first();
+    double z = 0.0;
+    
+    Q_FOREACH (Link* in, outNeuron->inConnections()) {
+        z += (outputs[in->predecessor()->id()] * in->weight());
+    }
     
+    return outNeuron->activation(z);
+}
+
+void Network::toDense(DenseNetwork* dense) const
+{
+    int inputIndex[MAX_NEURONS];
+    int hiddenIndex[MAX_NEURONS];
+    
+    for (int i = 0; i < m_inputNeurons.size(); i++) {
+        inputIndex[ m_inputNeurons[i]->id() ] = i;
+    }
+    
+    for (int j = 0; j < m_hiddenNeurons.size(); j++) {
+        hiddenIndex[ m_hiddenNeurons[j]->id() ] = j;
+    }
+    
+    dense->hiddenCount = m_hiddenNeurons.size();
+    
+    for (int i = 0; i < m_inputNeurons.size(); i++) {
+        QList< Link* > inLinks = m_inputNeurons[i]->inConnections();
+        
+        dense->inputWeights[i] = inLinks.first()->weight();
+        dense->inputBias[i] = 0.0;
+        
+        for (int k = 1; k < inLinks.size(); k++) {
+            dense->inputBias[i] += inLinks[k]->output() * inLinks[k]->weight();
+        }
+    }
+    
+    for (int j = 0; j < HIDDEN_SIZE_MAX; j++) {
+        dense->hiddenBias[j] = 0.0;
+        dense->outputWeights[j] = 0.0;
+        
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            dense->hiddenWeights[j][i] = 0.0;
+        }
+    }
+    
+    for (int j = 0; j < m_hiddenNeurons.size(); j++) {
+        Q_FOREACH (Link* in, m_hiddenNeurons[j]->inConnections()) {
+            int predecessor = in->predecessor()->id();
+            
+            if (predecessor == BIAS_NEURON_ID) {
+                dense->hiddenBias[j] = in->weight();
+            } else {
+                dense->hiddenWeights[j][ inputIndex[predecessor] ] = in->weight();
+            }
+        }
+    }
+    
+    dense->outputBias = 0.0;
+    
+    Q_FOREACH (Link* in, m_outputNeurons.first()->inConnections()) {
+        int predecessor = in->predecessor()->id();
+        
+        if (predecessor == BIAS_NEURON_ID) {
+            dense->outputBias = in->weight();
+        } else {
+            dense->outputWeights[ hiddenIndex[predecessor] ] = in->weight();
+        }
+    }
+}
+
+void Network::computeGradients(double target)
+{
     double out = m_outputNeurons.first()->output();
     double oGradient = (1 - out) * out * (target - out);
 
@@ -274,149 +590,68 @@ void Network::computeGradients(int expectedClass)
 
 void Network::mutate(MutationOperator op)
 {
+    INSTRUMENT_MUTATION(op);
+    
     switch (op) {
 
         case RemoveLink: {
-            if (m_connectivity.complexity() < LINK_SIZE_MIN) { /* avoid removing too many links, and mutate the weights instead */
+            if (m_connectivity.complexity() < m_config->linkSizeMin) { /* avoid removing too many links, and mutate the weights instead */
                 applyGaussianMutation();
                 break;
             }
             
-            int in = 0;
-            int out = 0;
-            
-            int linkType = randomInteger(1, 2);
-            int inMin, inMax, outMin, outMax;
-            inMin = inMax = outMin = outMax = 0;
+            if (m_existingLinks[InputToHidden].size() + m_existingLinks[HiddenToOutput].size() == 0) { /* only biases left */
+                applyGaussianMutation();
+                break;
+            }
             
             /*
-             * Determines in which range the IDs should be randomly chosen, depending on whether we're removing a link
-             * between input and hidden, or between hidden and output (no other kind is allowed).
+             * Picks uniformly among all the links between input and hidden, or between hidden and output neurons
+             * (bias links are never removed).
              */
-            switch (linkType) {
-                case 1: { /* Link between input and hidden neuron */
-                    inMin = 1;
-                    inMax = INPUT_SIZE;
-                    outMin = INPUT_SIZE + OUTPUT_SIZE + 1;
-                    outMax = maxNeuronId;
-                    break;
-                }
-                
-                case 2: { /* Between hidden and output */
-                    inMin = INPUT_SIZE + OUTPUT_SIZE + 1;
-                    inMax = maxNeuronId;
-                    outMin = INPUT_SIZE + 1;
-                    outMax = INPUT_SIZE + OUTPUT_SIZE;
-                    break;
-                }
-                
-                default:
-                    break;
-            }
-            
-            int attempt = 0;
-            
-            do {
-                in = randomInteger(inMin, inMax);
-                out = randomInteger(outMin, outMax);
-                
-                if (++attempt > 20) {
-                    return;
-                }
-            } while (!m_connectivity.link(in, out));
-            
-            Link* link = m_connectivity.link(in, out);
-            link->predecessor()->removeOutConnection(link);
-            link->successor()->removeInConnection(link);
-            
-            m_connectivity.removeLink(in, out);
-            delete link;
-            link = 0;
+            QPair< int, int > pair = randomSlot(m_existingLinks);
+            removeLink(pair.first, pair.second);
             break;
         }
         
         case AddLink: {
-            int in = 0;
-            int out = 0;
-            bool found = false;
-            
-            int linkType = randomInteger(1, 2);
-            int inMin, inMax, outMin, outMax;
-            inMin = inMax = outMin = outMax = 0;
-            
-            /*
-             * Again determines the accepted range (see RemoveLink case).
-             */
-            switch (linkType) {
-                case 1: { /* Link between input and hidden neuron */
-                    inMin = 1;
-                    inMax = INPUT_SIZE;
-                    outMin = INPUT_SIZE + OUTPUT_SIZE + 1;
-                    outMax = maxNeuronId;
-                    break;
-                }
-                
-                case 2: { /* Link between hidden and output neuron */
-                    inMin = INPUT_SIZE + OUTPUT_SIZE + 1;
-                    inMax = maxNeuronId;
-                    outMin = INPUT_SIZE + 1;
-                    outMax = INPUT_SIZE + OUTPUT_SIZE;
-                    break;
-                }
+            if (m_freeLinks[InputToHidden].size() + m_freeLinks[HiddenToOutput].size() == 0) { /* fully connected */
+                applyGaussianMutation();
+                break;
             }
             
             /*
-             * Check all the pairs of neurons, and pick the first pair that isn't connected by a link.
+             * Picks uniformly among all the pairs of neurons in adjacent layers that aren't connected yet.
              */
-            for (in = inMin; in <= inMax; in++) {
-                for (out = outMin; out <= outMax; out++) {
-                    if (!m_connectivity.link(in, out) && !m_connectivity.link(out, in)) {
-                        found = true;
-                        
-                        Link* link = new Link(randomWeight(), m_neurons[in], m_neurons[out]);
-                        link->predecessor()->addOutConnection(link);
-                        link->successor()->addInConnection(link);
-                        
-                        m_connectivity.addLink(in, out, link);
-                        break;
-                    }
-                }
-                
-                if (found) {
-                    break;
-                }
-            }
+            QPair< int, int > pair = randomSlot(m_freeLinks);
+            
+            Link* link = new Link(randomWeight(), m_neurons.at(pair.first), m_neurons.at(pair.second), m_config->initialStep);
+            link->predecessor()->addOutConnection(link);
+            link->successor()->addInConnection(link);
+            
+            m_connectivity.addLink(pair.first, pair.second, link);
+            m_freeLinks[ linkLayers(link) ].remove(pair.first, pair.second);
+            m_existingLinks[ linkLayers(link) ].insert(pair.first, pair.second);
             break;
         }
         
         /*
-         * NOTE: when removing a neuron, the last one in the list, i.e. the one with the biggest ID, gets the ID of the removed
-         * one (if they don't coincide). This simplifies a lot of loops in the network.
+         * NOTE: the other neurons keep their IDs; the slot of the removed one is reused by the next
+         * AddNeuron mutation.
          */
         case RemoveNeuron: {
-            if (m_hiddenNeurons.size() <= HIDDEN_SIZE_MIN) { /* avoid removing all neurons, and mutate weights instead */
+            if (m_hiddenNeurons.size() <= m_config->hiddenSizeMin) { /* avoid removing all neurons, and mutate weights instead */
                 applyGaussianMutation();
                 break;
             }
             
-            int neuronId = randomInteger(INPUT_SIZE + OUTPUT_SIZE + 1, maxNeuronId);
-            Neuron* neuron = m_neurons[neuronId];
+            Neuron* neuron = m_hiddenNeurons[ randomInteger(0, m_hiddenNeurons.size()) ];
             
+            removeLinkSlots(neuron);
             m_hiddenNeurons.removeOne(neuron);
-            m_neurons.remove(neuronId);
-            m_connectivity.removeAllLinks(neuronId, maxNeuronId, m_neurons);
-            
-            if (neuronId != maxNeuronId) {
-                Neuron* latestNeuron = m_neurons[maxNeuronId];
-                int oldId = latestNeuron->id();
-                latestNeuron->setId(neuronId);
-                
-                m_neurons.remove(oldId);
-                m_neurons.insert(neuronId, latestNeuron);
-                m_connectivity.changeId(oldId, neuronId);
-            }
+            m_connectivity.removeAllLinks(neuron);
+            m_neurons.remove( neuron->id() );
             
-            maxNeuronId--;
             delete neuron;
             neuron = 0;
             break;
@@ -431,11 +666,11 @@ void Network::mutate(MutationOperator op)
                 break;
             }
             
-            int neuronId = ++maxNeuronId;
+            int neuronId = m_neurons.nextId();
             Neuron* neuron = new SigmoidNeuron(neuronId, Neuron::HiddenLayer);
             
-            createBiasLink(m_neurons[-1], neuron);
-            m_neurons.insert(neuronId, neuron);
+            createBiasLink(m_neurons.at(BIAS_NEURON_ID), neuron);
+            m_neurons.insert(neuron);
             m_hiddenNeurons.append(neuron);
             
             /*
@@ -445,7 +680,7 @@ void Network::mutate(MutationOperator op)
                 int choice = randomInteger(1, 2);
                 
                 if (choice == 1) {
-                    Link* link = new Link(randomWeight(), inputNeuron, neuron);
+                    Link* link = new Link(randomWeight(), inputNeuron, neuron, m_config->initialStep);
                     inputNeuron->addOutConnection(link);
                     neuron->addInConnection(link);
                     
@@ -458,13 +693,14 @@ void Network::mutate(MutationOperator op)
              * to it (the link may be removed by further mutations).
              */
             Q_FOREACH (Neuron* outputNeuron, m_outputNeurons) {
-                Link* link = new Link(randomWeight(), neuron, outputNeuron);
+                Link* link = new Link(randomWeight(), neuron, outputNeuron, m_config->initialStep);
                 neuron->addOutConnection(link);
                 outputNeuron->addInConnection(link);
                 
                 m_connectivity.addLink(neuronId, outputNeuron->id(), link);
             }
             
+            addLinkSlots(neuron);
             break;
         }
         
@@ -478,6 +714,171 @@ void Network::mutate(MutationOperator op)
     }
 }
 
+bool Network::isConsistent() const
+{
+    const QList< Neuron* >* layers[] = { &m_inputNeurons, &m_hiddenNeurons, &m_outputNeurons };
+    int neurons = 1;
+    
+    if (!m_neurons.isConsistent() || !m_neurons.at(BIAS_NEURON_ID)) {
+        return false;
+    }
+    
+    for (int l = 0; l < 3; l++) {
+        Q_FOREACH (Neuron* neuron, *layers[l]) {
+            if (m_neurons.at( neuron->id() ) != neuron) {
+                return false;
+            }
+        }
+        
+        neurons += layers[l]->size();
+    }
+    
+    if (neurons != m_neurons.size()) {
+        return false;
+    }
+    
+    /*
+     * Every neuron but the bias has a bias link, and any other link is in the existing slots: no link is
+     * left out of them.
+     */
+    int links = neurons - 1;
+    
+    for (int i = 0; i < LinkLayersCount; i++) {
+        if (!m_existingLinks[i].isConsistent() || !m_freeLinks[i].isConsistent()) {
+            return false;
+        }
+        
+        links += m_existingLinks[i].size();
+    }
+    
+    if (links != m_connectivity.complexity()
+        || m_existingLinks[InputToHidden].size() + m_freeLinks[InputToHidden].size() != m_inputNeurons.size() * m_hiddenNeurons.size()
+        || m_existingLinks[HiddenToOutput].size() + m_freeLinks[HiddenToOutput].size() != m_hiddenNeurons.size() * m_outputNeurons.size()) {
+        return false;
+    }
+    
+    for (int l = 0; l < 3; l++) {
+        Q_FOREACH (Neuron* neuron, *layers[l]) {
+            if (!m_connectivity.link(BIAS_NEURON_ID, neuron->id())) {
+                return false;
+            }
+        }
+    }
+    
+    Q_FOREACH (Neuron* hidden, m_hiddenNeurons) {
+        Q_FOREACH (Neuron* inputNeuron, m_inputNeurons) {
+            if (!isConsistentSlot(InputToHidden, inputNeuron->id(), hidden->id())) {
+                return false;
+            }
+        }
+        
+        Q_FOREACH (Neuron* outputNeuron, m_outputNeurons) {
+            if (!isConsistentSlot(HiddenToOutput, hidden->id(), outputNeuron->id())) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+/*
+ * The pair is in exactly one of the slot sets of its layer: the existing links if the neurons are linked,
+ * the free ones otherwise.
+ */
+bool Network::isConsistentSlot(LinkLayers layer, int in, int out) const
+{
+    bool linked = (m_connectivity.link(in, out) != NULL);
+    
+    return (m_existingLinks[layer].contains(in, out) == linked && m_freeLinks[layer].contains(in, out) != linked);
+}
+
+QList< QPair< int, int > > Network::removableLinks() const
+{
+    QList< QPair< int, int > > links;
+    
+    for (int i = 0; i < LinkLayersCount; i++) {
+        for (int p = 0; p < m_existingLinks[i].size(); p++) {
+            links.append( m_existingLinks[i].at(p) );
+        }
+    }
+    
+    return links;
+}
+
+bool Network::removeLink(int in, int out)
+{
+    Link* link = m_connectivity.link(in, out);
+    
+    if (!link || in == BIAS_NEURON_ID) {
+        return false;
+    }
+    
+    link->predecessor()->removeOutConnection(link);
+    link->successor()->removeInConnection(link);
+    
+    m_connectivity.removeLink(in, out);
+    m_existingLinks[ linkLayers(link) ].remove(in, out);
+    m_freeLinks[ linkLayers(link) ].insert(in, out);
+    
+    delete link;
+    return true;
+}
+
+Network::LinkLayers Network::linkLayers(const Link* link)
+{
+    return (link->predecessor()->layer() == Neuron::InputLayer) ? InputToHidden : HiddenToOutput;
+}
+
+/*
+ * Each pair of neurons that can be connected is either in m_existingLinks or in m_freeLinks.
+ */
+void Network::addLinkSlots(Neuron* hidden)
+{
+    Q_FOREACH (Neuron* inputNeuron, m_inputNeurons) {
+        if (m_connectivity.link(inputNeuron->id(), hidden->id())) {
+            m_existingLinks[InputToHidden].insert(inputNeuron->id(), hidden->id());
+        } else {
+            m_freeLinks[InputToHidden].insert(inputNeuron->id(), hidden->id());
+        }
+    }
+    
+    Q_FOREACH (Neuron* outputNeuron, m_outputNeurons) {
+        if (m_connectivity.link(hidden->id(), outputNeuron->id())) {
+            m_existingLinks[HiddenToOutput].insert(hidden->id(), outputNeuron->id());
+        } else {
+            m_freeLinks[HiddenToOutput].insert(hidden->id(), outputNeuron->id());
+        }
+    }
+}
+
+void Network::removeLinkSlots(Neuron* hidden)
+{
+    Q_FOREACH (Neuron* inputNeuron, m_inputNeurons) {
+        m_existingLinks[InputToHidden].remove(inputNeuron->id(), hidden->id());
+        m_freeLinks[InputToHidden].remove(inputNeuron->id(), hidden->id());
+    }
+    
+    Q_FOREACH (Neuron* outputNeuron, m_outputNeurons) {
+        m_existingLinks[HiddenToOutput].remove(hidden->id(), outputNeuron->id());
+        m_freeLinks[HiddenToOutput].remove(hidden->id(), outputNeuron->id());
+    }
+}
+
+/*
+ * Picks a pair uniformly from the union of the two sets; they must not be both empty.
+ */
+QPair< int, int > Network::randomSlot(const LinkSlotSet slots[])
+{
+    int position = randomInteger(0, slots[InputToHidden].size() + slots[HiddenToOutput].size());
+    
+    if (position < slots[InputToHidden].size()) {
+        return slots[InputToHidden].at(position);
+    }
+    
+    return slots[HiddenToOutput].at(position - slots[InputToHidden].size());
+}
+
 void Network::applyGaussianMutation()
 {
     Q_FOREACH (Link* link, m_connectivity.links()) {
@@ -501,23 +902,35 @@ int Network::complexity() const
     return m_connectivity.complexity();
 }
 
-double Network::sparsity() const
-{
-    return m_sparsity;
-}
-
-void Network::setSparsity(double s)
-{
-    m_sparsity = s;
-}
-
-void Network::addSparsity(double s)
+/*
+ * Besides the links in the matrix, each input neuron owns the fake link used to set its input.
+ */
+MemoryFootprint Network::memoryFootprint() const
 {
-    m_sparsity += s;
+    MemoryFootprint footprint;
+    
+    Q_FOREACH (Neuron* neuron, m_neurons.neurons()) {
+        footprint.neurons += neuron->memoryFootprint();
+    }
+    
+    footprint.links = (m_connectivity.complexity() + m_inputNeurons.size()) * MemoryFootprint::allocation( sizeof(Link) );
+    
+    footprint.index = MemoryFootprint::allocation( sizeof(*this) )
+                    + m_neurons.memoryFootprint()
+                    + m_existingLinks[InputToHidden].memoryFootprint() + m_existingLinks[HiddenToOutput].memoryFootprint()
+                    + m_freeLinks[InputToHidden].memoryFootprint() + m_freeLinks[HiddenToOutput].memoryFootprint()
+                    + MemoryFootprint::pointerList( m_inputNeurons.size() )
+                    + MemoryFootprint::pointerList( m_hiddenNeurons.size() )
+                    + MemoryFootprint::pointerList( m_outputNeurons.size() )
+                    + m_connectivity.memoryFootprint();
+    
+    return footprint;
 }
 
 void Network::updateByRProp()
 {    
+    INSTRUMENT_COUNT(LinkUpdates, m_connectivity.complexity());
+    
     /* Train weights */
     Q_FOREACH (Link* link, m_connectivity.links()) {        
         double gradient = link->gradient();
@@ -530,11 +943,11 @@ void Network::updateByRProp()
         double weightChange = 0.0;
         
         if (signChange > 0) {
-            delta = minimum(oldDelta * POSITIVE_ETA, MAX_STEP);
+            delta = minimum(oldDelta * m_config->positiveEta, m_config->maxStep);
             weightChange = (gradient > 0) ? -delta : +delta; /* sign function */
         }
         else if (signChange < 0) {
-            delta = max(oldDelta * NEGATIVE_ETA, MIN_STEP);
+            delta = max(oldDelta * m_config->negativeEta, m_config->minStep);
             
             if (m_lastError > m_oldError) { /* Rprop+ condition */
                 weightChange = (gradient > 0) ? +delta : -delta;
@@ -558,4 +971,26 @@ double Network::averageError() const
 void Network::setAverageError(double a)
 {
     m_averageError = a;
+}
+
+const Configuration& Network::configuration() const
+{
+    return *m_config;
+}
+
+void Network::setConfiguration(const SharedConfiguration& config)
+{
+    Q_ASSERT (config->isValid());
+    
+    m_config = config;
+}
+
+int Network::voteWeight() const
+{
+    return m_voteWeight;
+}
+
+void Network::setVoteWeight(int weight)
+{
+    m_voteWeight = weight;
 }
\ No newline at end of file
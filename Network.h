@@ -9,25 +9,74 @@
 #include "Link.h"
 #include "Utils.h"
 #include "LinkMatrix.h"
+#include "NeuronStore.h"
+#include "LinkSlotSet.h"
 #include "ProblemInfo.h"
+#include "MemoryFootprint.h"
+#include "DenseNetwork.h"
+#include "Configuration.h"
 
 #include <QtCore/QList>
 #include <QtCore/QMap>
-#include <QHash>
+#include <QtCore/QDataStream>
+
+/* ID of the fake neuron all bias links come from */
+#define BIAS_NEURON_ID 0
 
 class Network
 {
 public:
-    explicit Network(int);
+    /*
+     * A new random network, shaped and later mutated and trained as the configuration says, which must
+     * be valid; a copy shares the configuration of the original.
+     */
+    explicit Network(int, const SharedConfiguration& = defaultConfiguration());
     explicit Network(const Network *, int);
     virtual ~Network();
     
+    const Configuration& configuration() const;
+    void setConfiguration(const SharedConfiguration &);
+    
+    /*
+     * The genome of the network (neurons, links with their weights, average error) through a stream, to
+     * move networks between processes or islands and to save them. load() gives a network equal to a copy
+     * of the saved one (though the mutations may pick its links in another order), with the given ID and
+     * configuration, or NULL if the data is corrupt or describes a network the constructor and the
+     * mutations couldn't have made.
+     */
+    void save(QDataStream &) const;
+    static Network* load(QDataStream &, int, const SharedConfiguration& = defaultConfiguration());
+    
     /*
      * Apply an input: the two parameters are the input vector (assumed to be of INPUT_SIZE dimension), and
      * the expected class.
      */
     void applyInput(double [], int);
     
+    /*
+     * Same as applyInput(), but the expected output is any value in [-1, 1] instead of a class (-1 for
+     * class 0, 1 for class 1), e.g. the soft vote of an ensemble. The classification error is measured
+     * against the class on the same side of 0.
+     */
+    void applyTarget(double [], double);
+    
+    /*
+     * Forward pass only, for evaluation: returns the class predicted for an input vector (of INPUT_SIZE
+     * dimension). Unlike applyInput() it doesn't compute errors or gradients and doesn't touch the state
+     * of neurons and links, so the RPROP state stays clean and more threads can use the same network.
+     */
+    int predict(const double []) const;
+    
+    /*
+     * Same as above, but returns the output of the output neuron, in [-1, 1].
+     */
+    double predictOutput(const double []) const;
+    
+    /*
+     * Copies the weights into fixed-size arrays, for the batched evaluation kernels.
+     */
+    void toDense(DenseNetwork *) const;
+    
     /*
      * Unique identifier for this network.
      */
@@ -54,9 +103,9 @@ public:
     int complexity() const;
     
     /*
-     * The sparsity computed by the genetic algorithm.
+     * Bytes taken by neurons, links and index structures of this network.
      */
-    double sparsity() const;
+    MemoryFootprint memoryFootprint() const;
     
     /*
      * Returns neurons and links in the network, given their IDs; for the Link, we need the IDs of
@@ -65,16 +114,44 @@ public:
     Neuron* getNeuron(int) const;
     Link* getLink(int, int) const;
     
+    /*
+     * Stable references to neurons: a handle stays valid across mutations until its neuron is removed,
+     * after which getNeuron() returns NULL for it. Handles are also valid on copies of this network.
+     */
+    Neuron* getNeuron(const NeuronHandle &) const;
+    NeuronHandle neuronHandle(int) const;
+    
     void setId(int);
     void setAverageError(double);
-    void setSparsity(double);
-    void addSparsity(double);
+    
+    /*
+     * How many votes the network casts in an ensemble: more than one when it stands for identical
+     * networks that have been merged (see EnsembleCompactor).
+     */
+    int voteWeight() const;
+    void setVoteWeight(int);
+    
+    /*
+     * The links between input and hidden neurons and between hidden and output neurons, as pairs of
+     * neuron IDs; removeLink() removes one of them, and returns false if there is no such link. Bias
+     * links are never listed nor removed.
+     */
+    QList< QPair< int, int > > removableLinks() const;
+    bool removeLink(int, int);
     
     /*
      * Performs a mutation on the network.
      */
     void mutate(MutationOperator);
     
+    /*
+     * True if the neuron store holds exactly the bias and the neurons of the layers, each in the slot of
+     * its ID, and if the link slots split the pairs of neurons in adjacent layers into the linked and the
+     * unlinked ones, as the link matrix says. Holds after every mutation; load() refuses genomes for which
+     * it doesn't.
+     */
+    bool isConsistent() const;
+    
     /*
      * The RPROP+ algorithm.
      */
@@ -86,20 +163,37 @@ public:
     bool operator== (const Network &);
     
 private:
+    explicit Network(); /* an empty network, for load() */
+    
     int m_id;
     
     QList< Neuron* > m_inputNeurons;
     QList< Neuron* > m_hiddenNeurons;
     QList< Neuron* > m_outputNeurons;
-    QHash< int, Neuron* > m_neurons; /* all the neurons indexed by ID */
-    int maxNeuronId; /* the biggest neuron ID currently active (used for mutations) */
+    NeuronStore m_neurons; /* all the neurons indexed by ID */
+    
+    /*
+     * Links can only go from input to hidden neurons, and from hidden to output neurons. For both kinds,
+     * we keep the pairs of neurons that are connected and those that aren't, so the mutations can pick one
+     * at random in constant time.
+     */
+    enum LinkLayers {
+        InputToHidden = 0,
+        HiddenToOutput,
+        LinkLayersCount
+    };
+    
+    LinkSlotSet m_existingLinks[LinkLayersCount];
+    LinkSlotSet m_freeLinks[LinkLayersCount];
     
     LinkMatrix m_connectivity;
     
     double m_lastOutput;
     double m_lastError, m_oldError; /* the "previous" error is used for RPROP+ */
     double m_averageError;
-    double m_sparsity;
+    int m_voteWeight;
+    
+    SharedConfiguration m_config;
     
     /*
      * Returns a random weight.
@@ -112,8 +206,18 @@ private:
     double randomBias();
     void createRandomLink(int, int);
     void createBiasLink(Neuron*, Neuron* );
-    void computeGradients(int);
+    void computeGradients(double);
     void applyGaussianMutation();
+    
+    /*
+     * Keep m_existingLinks and m_freeLinks up to date when hidden neurons are added or removed.
+     */
+    static LinkLayers linkLayers(const Link *);
+    static bool isAllowedLink(const Neuron *, const Neuron *);
+    bool isConsistentSlot(LinkLayers, int, int) const;
+    void addLinkSlots(Neuron *);
+    void removeLinkSlots(Neuron *);
+    static QPair< int, int > randomSlot(const LinkSlotSet []);
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Neuron.h"
 #include "Utils.h"
+#include "MemoryFootprint.h"
+#include "Instrumentation.h"
 #include <cmath>
 #include <iostream>
 
@@ -9,13 +11,17 @@ Neuron::Neuron(int id, Neuron::Layer layer)
     : m_id(id)
     , m_layer(layer)
     , m_sigError(0.0f)
-{}
+{
+    INSTRUMENT_COUNT(NeuronAllocations, 1);
+}
 
 Neuron::Neuron(int id, Neuron* other)
     : m_id(id)
     , m_layer( other->layer() )
     , m_sigError(0.0f)
-{}
+{
+    INSTRUMENT_COUNT(NeuronAllocations, 1);
+}
 
 Neuron::~Neuron()
 {}
@@ -92,6 +98,13 @@ void Neuron::setSignalError(double err)
     m_sigError = err;
 }
 
+qint64 Neuron::memoryFootprint() const
+{
+    return MemoryFootprint::allocation( sizeof(*this) )
+            + MemoryFootprint::pointerList( m_inConnections.size() )
+            + MemoryFootprint::pointerList( m_outConnections.size() );
+}
+
 bool Neuron::operator==(const Neuron& other) const
 {
     return m_id == other.id();
@@ -120,7 +133,7 @@ void SigmoidNeuron::computeOutput()
         z += (in->output() * in->weight());
     }
     
-    m_lastOutput = 1.0f / (1.0f + exp(-z));
+    m_lastOutput = activation(z);
     
     /*
      * Sets the output on the outgoing link, so it can be retrieved by the
@@ -131,6 +144,11 @@ void SigmoidNeuron::computeOutput()
     }
 }
 
+double SigmoidNeuron::activation(double z) const
+{
+    return sigmoid(z);
+}
+
 TangentNeuron::TangentNeuron(int id, Neuron::Layer layer)
     : Neuron(id, layer)
 {}
@@ -150,15 +168,14 @@ void TangentNeuron::computeOutput()
         z += (in->output() * in->weight());
     }
     
-    if (z < -10.0) {
-        m_lastOutput = -1.0;
-    } else if (z > 10.0) {
-        m_lastOutput = 1.0;
-    } else {
-        m_lastOutput = tanh(z);
-    }
+    m_lastOutput = activation(z);
         
     Q_FOREACH (Link* out, m_outConnections) {
         out->setOutput(m_lastOutput);
     }    
+}
+
+double TangentNeuron::activation(double z) const
+{
+    return clampedTangent(z);
 }
\ No newline at end of file
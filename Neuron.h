@@ -58,11 +58,22 @@ public:
     virtual void setId(int);
     virtual void setSignalError(double);
     
+    /*
+     * Bytes taken by this neuron, including its connection lists (but not the links themselves).
+     */
+    virtual qint64 memoryFootprint() const;
+    
     /*
      * Each neuron computes the output in its specific way.
      */
     virtual void computeOutput() = 0;
     
+    /*
+     * The activation function applied to the weighted sum of the inputs; it doesn't change
+     * the state of the neuron.
+     */
+    virtual double activation(double) const = 0;
+    
     bool operator==(const Neuron &) const;
     
 protected:
@@ -83,6 +94,7 @@ public:
     virtual ~SigmoidNeuron();
     
     virtual void computeOutput();
+    virtual double activation(double) const;
 };
 
 class TangentNeuron : public Neuron
@@ -93,6 +105,7 @@ public:
     virtual ~TangentNeuron();
 
     virtual void computeOutput();
+    virtual double activation(double) const;
 };
 
 #endif
\ No newline at end of file
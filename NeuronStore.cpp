@@ -0,0 +1,258 @@
+#include "NeuronStore.h"
+#include "Neuron.h"
+#include "MemoryFootprint.h"
+#include "ProblemInfo.h"
+
+#include <QtAlgorithms>
+
+NeuronHandle::NeuronHandle()
+    : m_id(-1)
+    , m_generation(0)
+{}
+
+NeuronHandle::NeuronHandle(int id, int generation)
+    : m_id(id)
+    , m_generation(generation)
+{}
+
+int NeuronHandle::id() const
+{
+    return m_id;
+}
+
+int NeuronHandle::generation() const
+{
+    return m_generation;
+}
+
+bool NeuronHandle::isNull() const
+{
+    return m_id < 0;
+}
+
+bool NeuronHandle::operator==(const NeuronHandle& other) const
+{
+    return m_id == other.m_id && m_generation == other.m_generation;
+}
+
+bool NeuronHandle::operator!=(const NeuronHandle& other) const
+{
+    return !(*this == other);
+}
+
+NeuronStore::NeuronStore()
+    : m_size(0)
+{}
+
+NeuronStore::~NeuronStore()
+{
+    qDeleteAll( neurons() );
+}
+
+/*
+ * The most recently freed slot is reused first.
+ */
+int NeuronStore::nextId() const
+{
+    return m_freeSlots.isEmpty() ? m_slots.size() : m_freeSlots.last();
+}
+
+NeuronHandle NeuronStore::insert(Neuron* neuron)
+{
+    Q_ASSERT (neuron->id() == nextId());
+    
+    if (m_freeSlots.isEmpty()) {
+        Slot slot;
+        slot.neuron = neuron;
+        slot.generation = 0;
+        m_slots.append(slot);
+    } else {
+        m_freeSlots.removeLast();
+        m_slots[neuron->id()].neuron = neuron;
+    }
+    
+    m_size++;
+    return handle( neuron->id() );
+}
+
+Neuron* NeuronStore::remove(int id)
+{
+    Neuron* neuron = at(id);
+    
+    if (!neuron) {
+        return 0;
+    }
+    
+    m_slots[id].neuron = 0;
+    m_slots[id].generation++;
+    m_freeSlots.append(id);
+    m_size--;
+    
+    return neuron;
+}
+
+Neuron* NeuronStore::at(int id) const
+{
+    if (id < 0 || id >= m_slots.size()) {
+        return 0;
+    }
+    
+    return m_slots[id].neuron;
+}
+
+Neuron* NeuronStore::get(const NeuronHandle& h) const
+{
+    return isValid(h) ? m_slots[h.id()].neuron : 0;
+}
+
+NeuronHandle NeuronStore::handle(int id) const
+{
+    if (!at(id)) {
+        return NeuronHandle();
+    }
+    
+    return NeuronHandle(id, m_slots[id].generation);
+}
+
+bool NeuronStore::isValid(const NeuronHandle& h) const
+{
+    return at( h.id() ) && m_slots[h.id()].generation == h.generation();
+}
+
+QList< Neuron* > NeuronStore::neurons() const
+{
+    QList< Neuron* > result;
+    
+    for (int i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].neuron) {
+            result.append(m_slots[i].neuron);
+        }
+    }
+    
+    return result;
+}
+
+int NeuronStore::size() const
+{
+    return m_size;
+}
+
+int NeuronStore::capacity() const
+{
+    return m_slots.size();
+}
+
+void NeuronStore::copyLayout(const NeuronStore& other)
+{
+    m_slots = other.m_slots;
+    m_freeSlots = other.m_freeSlots;
+    m_size = 0;
+    
+    for (int i = 0; i < m_slots.size(); i++) {
+        m_slots[i].neuron = 0;
+    }
+}
+
+void NeuronStore::place(Neuron* neuron)
+{
+    Q_ASSERT (neuron->id() < m_slots.size() && !m_slots[neuron->id()].neuron);
+    
+    m_slots[neuron->id()].neuron = neuron;
+    m_size++;
+}
+
+void NeuronStore::writeLayout(QDataStream& stream) const
+{
+    stream << (qint32)m_slots.size();
+    
+    Q_FOREACH (const Slot& slot, m_slots) {
+        stream << (qint32)slot.generation;
+    }
+    
+    stream << (qint32)m_freeSlots.size();
+    
+    Q_FOREACH (int id, m_freeSlots) {
+        stream << (qint32)id;
+    }
+}
+
+bool NeuronStore::readLayout(QDataStream& stream)
+{
+    qint32 slotCount, freeCount;
+    
+    stream >> slotCount;
+    
+    if (stream.status() != QDataStream::Ok || slotCount < 0 || slotCount > MAX_NEURONS) {
+        return false;
+    }
+    
+    m_slots.resize(slotCount);
+    m_size = 0;
+    
+    for (int i = 0; i < slotCount; i++) {
+        qint32 generation;
+        stream >> generation;
+        
+        m_slots[i].neuron = 0;
+        m_slots[i].generation = generation;
+    }
+    
+    stream >> freeCount;
+    
+    if (stream.status() != QDataStream::Ok || freeCount < 0 || freeCount > slotCount) {
+        return false;
+    }
+    
+    m_freeSlots.clear();
+    
+    for (int i = 0; i < freeCount; i++) {
+        qint32 id;
+        stream >> id;
+        
+        if (id < 0 || id >= slotCount) {
+            return false;
+        }
+        
+        m_freeSlots.append(id);
+    }
+    
+    return stream.status() == QDataStream::Ok;
+}
+
+bool NeuronStore::isConsistent() const
+{
+    if (m_size + m_freeSlots.size() != m_slots.size()) {
+        return false;
+    }
+    
+    int neurons = 0;
+    
+    for (int id = 0; id < m_slots.size(); id++) {
+        if (m_slots[id].neuron && m_slots[id].neuron->id() != id) {
+            return false;
+        }
+        
+        neurons += m_slots[id].neuron ? 1 : 0;
+    }
+    
+    if (neurons != m_size) {
+        return false;
+    }
+    
+    QVector< int > freeSlots = m_freeSlots;
+    qSort(freeSlots.begin(), freeSlots.end());
+    
+    for (int i = 0; i < freeSlots.size(); i++) {
+        if (m_slots[ freeSlots[i] ].neuron || (i > 0 && freeSlots[i] == freeSlots[i - 1])) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+qint64 NeuronStore::memoryFootprint() const
+{
+    return MemoryFootprint::allocation( m_slots.capacity() * sizeof(Slot) )
+            + MemoryFootprint::allocation( m_freeSlots.capacity() * sizeof(int) );
+}
@@ -0,0 +1,122 @@
+/*
+ * This class holds the neurons of a network in numbered slots. The ID of a neuron is the index of its slot,
+ * and it never changes: removing a neuron frees its slot, which is reused by the next insertion.
+ * 
+ * Each slot also has a generation, increased every time its neuron is removed. A NeuronHandle records both,
+ * so a handle taken before a removal is detected as stale instead of silently pointing to the neuron that
+ * took the slot afterwards.
+ */
+
+#ifndef NEURONSTORE_H
+#define NEURONSTORE_H
+
+#include <QList>
+#include <QVector>
+#include <QDataStream>
+
+class Neuron;
+
+class NeuronHandle
+{
+public:
+    NeuronHandle();
+    explicit NeuronHandle(int, int);
+    
+    int id() const;
+    int generation() const;
+    
+    /*
+     * True for handles that have never been assigned.
+     */
+    bool isNull() const;
+    
+    bool operator==(const NeuronHandle &) const;
+    bool operator!=(const NeuronHandle &) const;
+    
+private:
+    int m_id;
+    int m_generation;
+};
+
+class NeuronStore
+{
+public:
+    explicit NeuronStore();
+    virtual ~NeuronStore(); /* deletes all the neurons still in the store */
+    
+    /*
+     * The ID the next inserted neuron will get: neurons must be created with this ID.
+     */
+    int nextId() const;
+    
+    /*
+     * Adds a neuron, created with nextId() as ID.
+     */
+    NeuronHandle insert(Neuron *);
+    
+    /*
+     * Removes the neuron with the given ID and returns it: the caller has to delete it.
+     */
+    Neuron* remove(int);
+    
+    /*
+     * Returns the neuron with the given ID, or NULL if there is none.
+     */
+    Neuron* at(int) const;
+    
+    /*
+     * Returns the neuron a handle refers to, or NULL if the handle is stale.
+     */
+    Neuron* get(const NeuronHandle &) const;
+    
+    NeuronHandle handle(int) const;
+    bool isValid(const NeuronHandle &) const;
+    
+    /*
+     * Returns all the neurons, in order of ID.
+     */
+    QList< Neuron* > neurons() const;
+    
+    /*
+     * The number of neurons, and the number of slots (all IDs are smaller than this).
+     */
+    int size() const;
+    int capacity() const;
+    
+    /*
+     * Makes this store a copy of @other without the neurons: same slots, generations and free slots.
+     * The copied neurons are then added with place().
+     */
+    void copyLayout(const NeuronStore &);
+    void place(Neuron *);
+    
+    /*
+     * Same as above, through a stream: writeLayout() saves slots, generations and free slots, readLayout()
+     * loads them into an empty store, returning false if the data is corrupt.
+     */
+    void writeLayout(QDataStream &) const;
+    bool readLayout(QDataStream &);
+    
+    /*
+     * True if every slot either holds the neuron with its ID or is free, but not both: checks a layout
+     * read from a stream once its neurons have been placed.
+     */
+    bool isConsistent() const;
+    
+    /*
+     * Bytes taken by the slots (the neurons themselves are not included).
+     */
+    qint64 memoryFootprint() const;
+    
+private:
+    struct Slot {
+        Neuron* neuron;
+        int generation;
+    };
+    
+    QVector< Slot > m_slots;
+    QVector< int > m_freeSlots;
+    int m_size;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "ObjectiveTable.h"
+
+ObjectiveTable::ObjectiveTable()
+{}
+
+ObjectiveTable::~ObjectiveTable()
+{}
+
+int ObjectiveTable::insert(Network* network)
+{
+    int row;
+
+    if (!m_freeRows.isEmpty()) {
+        row = m_freeRows.last();
+        m_freeRows.removeLast();
+    } else {
+        row = m_networks.size();
+
+        m_networks.append(NULL);
+        m_errors.append(0);
+        m_complexities.append(0);
+        m_normalizedErrors.append(0);
+        m_normalizedComplexities.append(0);
+    }
+
+    m_networks[row] = network;
+    m_rows.insert(network, row);
+    refresh(row);
+
+    return row;
+}
+
+void ObjectiveTable::remove(int row)
+{
+    m_rows.remove( m_networks[row] );
+    m_networks[row] = NULL;
+    m_freeRows.append(row);
+}
+
+bool ObjectiveTable::isStale(int row) const
+{
+    const Network* network = m_networks[row];
+    return network->averageError() != m_errors[row] || network->complexity() != m_complexities[row];
+}
+
+void ObjectiveTable::refresh(int row)
+{
+    const Network* network = m_networks[row];
+
+    m_errors[row] = network->averageError();
+    m_complexities[row] = network->complexity();
+    m_normalizedErrors[row] = m_errors[row];
+    m_normalizedComplexities[row] = (double)m_complexities[row] / (double)LINK_SIZE_MAX;
+}
+
+int ObjectiveTable::row(Network* network) const
+{
+    return m_rows.value(network, -1);
+}
+
+Network* ObjectiveTable::network(int row) const
+{
+    return m_networks[row];
+}
+
+double ObjectiveTable::error(int row) const
+{
+    return m_errors[row];
+}
+
+int ObjectiveTable::complexity(int row) const
+{
+    return m_complexities[row];
+}
+
+double ObjectiveTable::normalizedError(int row) const
+{
+    return m_normalizedErrors[row];
+}
+
+double ObjectiveTable::normalizedComplexity(int row) const
+{
+    return m_normalizedComplexities[row];
+}
+
+bool ObjectiveTable::dominates(int row1, int row2) const
+{
+    if (m_errors[row1] < m_errors[row2] && m_complexities[row1] <= m_complexities[row2]) {
+        return true;
+    }
+
+    if (m_complexities[row1] < m_complexities[row2] && m_errors[row1] <= m_errors[row2]) {
+        return true;
+    }
+
+    return false;
+}
+
+bool ObjectiveTable::lessThan(int row1, int row2) const
+{
+    if (m_complexities[row1] != m_complexities[row2]) {
+        return m_complexities[row1] < m_complexities[row2];
+    }
+
+    return m_errors[row1] < m_errors[row2];
+}
+
+int ObjectiveTable::size() const
+{
+    return m_rows.size();
+}
+
+void ObjectiveTable::clear()
+{
+    m_networks.clear();
+    m_errors.clear();
+    m_complexities.clear();
+    m_normalizedErrors.clear();
+    m_normalizedComplexities.clear();
+    m_freeRows.clear();
+    m_rows.clear();
+}
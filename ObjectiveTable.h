@@ -0,0 +1,74 @@
+/*
+ * The objectives of a population, average error and complexity, in struct-of-arrays form: each network
+ * has a row, and each objective a contiguous column, so ranking and selection only touch the columns and
+ * sort row indices, never the networks themselves.
+ *
+ * Besides the raw objectives, the table keeps them normalized to [0, 1], dividing the complexity by
+ * LINK_SIZE_MAX (the error is already a fraction), so that both weigh the same in crowding distances.
+ *
+ * A network keeps its row until it is removed; the rows of removed networks are then reused.
+ */
+
+#ifndef OBJECTIVETABLE_H
+#define OBJECTIVETABLE_H
+
+#include <QHash>
+#include <QVector>
+
+#include "Network.h"
+
+class ObjectiveTable
+{
+public:
+    explicit ObjectiveTable();
+    virtual ~ObjectiveTable();
+
+    /*
+     * Adds a network, reading its objectives, and returns its row.
+     */
+    int insert(Network *);
+    void remove(int row);
+
+    /*
+     * Whether the objectives of the network in a row have changed since they were read, and reads
+     * them again.
+     */
+    bool isStale(int row) const;
+    void refresh(int row);
+
+    /*
+     * The row of a network, or -1.
+     */
+    int row(Network *) const;
+
+    Network* network(int row) const;
+    double error(int row) const;
+    int complexity(int row) const;
+    double normalizedError(int row) const;
+    double normalizedComplexity(int row) const;
+
+    /*
+     * Pareto dominance: better on one objective and not worse on the other.
+     */
+    bool dominates(int row1, int row2) const;
+
+    /*
+     * Orders rows by complexity, then by error.
+     */
+    bool lessThan(int row1, int row2) const;
+
+    int size() const;
+    void clear();
+
+private:
+    QVector< Network* > m_networks;
+    QVector< double > m_errors;
+    QVector< int > m_complexities;
+    QVector< double > m_normalizedErrors;
+    QVector< double > m_normalizedComplexities;
+
+    QVector< int > m_freeRows;
+    QHash< Network*, int > m_rows;
+};
+
+#endif
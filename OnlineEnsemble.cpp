@@ -0,0 +1,287 @@
+#include "OnlineEnsemble.h"
+#include "BatchEvaluator.h"
+#include "Tracing.h"
+
+#include <QMutexLocker>
+
+/*
+ * A front being served: copies of the networks, packed once. It is never modified after being built, so
+ * any number of threads can evaluate it at the same time.
+ */
+class ServingFront
+{
+public:
+    explicit ServingFront(const QList< Network* >& networks)
+        : m_networks(networks)
+        , m_evaluator( qMax(networks.size(), 1) )
+    {
+        m_evaluator.pack(m_networks);
+    }
+
+    ~ServingFront()
+    {
+        qDeleteAll(m_networks);
+    }
+
+    QVector< int > votes(const QList< InputSample* >& samples) const
+    {
+        QVector< int > votes(samples.size(), 0);
+
+        if (m_networks.isEmpty() || samples.isEmpty()) {
+            return votes;
+        }
+
+        QVector< char > classes(m_networks.size() * samples.size());
+        m_evaluator.evaluate(samples, 0, m_networks.size(), 0, samples.size(), classes.data());
+
+        for (int s = 0; s < samples.size(); s++) {
+            int answers[NUM_CLASSES];
+
+            for (int i = 0; i < NUM_CLASSES; i++) {
+                answers[i] = 0;
+            }
+
+            for (int n = 0; n < m_networks.size(); n++) {
+                answers[ (int)classes[n * samples.size() + s] ] += m_networks[n]->voteWeight();
+            }
+
+            for (int i = 1; i < NUM_CLASSES; i++) {
+                if (answers[i] > answers[ votes[s] ]) {
+                    votes[s] = i;
+                }
+            }
+        }
+
+        return votes;
+    }
+
+    QList< Network* > copies() const
+    {
+        QList< Network* > copies;
+
+        Q_FOREACH (const Network* net, m_networks) {
+            copies.append( new Network(net, net->id()) );
+        }
+
+        return copies;
+    }
+
+private:
+    QList< Network* > m_networks;
+    BatchEvaluator m_evaluator;
+};
+
+class OnlineTrainingThread : public QThread
+{
+public:
+    explicit OnlineTrainingThread(OnlineEnsemble* ensemble)
+        : m_ensemble(ensemble)
+    {}
+
+protected:
+    virtual void run()
+    {
+        if (TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->setThreadName("online training");
+        }
+
+        m_ensemble->run();
+    }
+
+private:
+    OnlineEnsemble* m_ensemble;
+};
+
+OnlineEnsemble::OnlineEnsemble(int networks, int threads, int windowSize, int refreshInterval, int refreshEpochs)
+    : m_ensemble(networks, threads)
+    , m_windowSize( qMax(windowSize, 2) )
+    , m_refreshInterval( qMax(refreshInterval, 1) )
+    , m_refreshEpochs( qMax(refreshEpochs, 1) )
+    , m_trainingStarted(false)
+    , m_newSamples(0)
+    , m_samplesSeen(0)
+    , m_stopping(false)
+    , m_thread(0)
+    , m_refreshes(0)
+{}
+
+OnlineEnsemble::~OnlineEnsemble()
+{
+    stop();
+
+    qDeleteAll(m_window);
+    qDeleteAll(m_refreshSamples);
+}
+
+void OnlineEnsemble::start()
+{
+    if (m_thread) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_windowLock);
+        m_stopping = false;
+    }
+
+    m_thread = new OnlineTrainingThread(this);
+    m_thread->start();
+}
+
+/*
+ * A refresh in progress is finished first.
+ */
+void OnlineEnsemble::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_windowLock);
+
+        m_stopping = true;
+        m_samplesAdded.wakeAll();
+    }
+
+    m_thread->wait();
+
+    delete m_thread;
+    m_thread = 0;
+}
+
+void OnlineEnsemble::addSample(const InputSample& sample)
+{
+    QMutexLocker locker(&m_windowLock);
+
+    m_window.append( new InputSample(sample) );
+
+    if (m_window.size() > m_windowSize) {
+        delete m_window.takeFirst();
+    }
+
+    m_newSamples++;
+    m_samplesSeen++;
+
+    if (m_newSamples >= m_refreshInterval) {
+        m_samplesAdded.wakeAll();
+    }
+}
+
+QVector< int > OnlineEnsemble::classify(const QList< InputSample* >& samples) const
+{
+    TRACE_SPAN("online classify", "inference");
+
+    QSharedPointer< ServingFront > front = currentServingFront();
+
+    if (front.isNull()) {
+        return QVector< int >(samples.size(), 0);
+    }
+
+    return front->votes(samples);
+}
+
+QList< Network* > OnlineEnsemble::servingFront() const
+{
+    QSharedPointer< ServingFront > front = currentServingFront();
+
+    if (front.isNull()) {
+        return QList< Network* >();
+    }
+
+    return front->copies();
+}
+
+int OnlineEnsemble::refreshes() const
+{
+    QMutexLocker locker(&m_servingLock);
+    return m_refreshes;
+}
+
+int OnlineEnsemble::samplesSeen() const
+{
+    QMutexLocker locker(&m_windowLock);
+    return m_samplesSeen;
+}
+
+QSharedPointer< ServingFront > OnlineEnsemble::currentServingFront() const
+{
+    QMutexLocker locker(&m_servingLock);
+    return m_serving;
+}
+
+/*
+ * The window is copied, newest sample first, so the refresh doesn't hold the lock and RPROP trains on
+ * the latest samples (see NetworkEnsemble::replaceSamples()).
+ */
+void OnlineEnsemble::run()
+{
+    while (true) {
+        QList< InputSample* > snapshot;
+
+        {
+            QMutexLocker locker(&m_windowLock);
+
+            while (!m_stopping && m_newSamples < m_refreshInterval) {
+                m_samplesAdded.wait(&m_windowLock);
+            }
+
+            if (m_stopping) {
+                break;
+            }
+
+            m_newSamples = 0;
+
+            for (int s = m_window.size() - 1; s >= 0; s--) {
+                snapshot.append( new InputSample(*m_window[s]) );
+            }
+        }
+
+        refresh(snapshot);
+    }
+}
+
+/*
+ * Samples go alternately to training and to measuring the networks, so both follow the stream.
+ */
+void OnlineEnsemble::refresh(const QList< InputSample* >& snapshot)
+{
+    TRACE_SPAN("online refresh", "training");
+
+    QList< InputSample* > training;
+    QList< InputSample* > measuring;
+
+    for (int s = 0; s < snapshot.size(); s++) {
+        if (s % 2 == 0) {
+            training.append(snapshot[s]);
+        } else {
+            measuring.append(snapshot[s]);
+        }
+    }
+
+    if (!m_trainingStarted) {
+        m_ensemble.beginTraining(training, measuring);
+        m_trainingStarted = true;
+    } else {
+        m_ensemble.replaceSamples(training, measuring);
+    }
+
+    qDeleteAll(m_refreshSamples);
+    m_refreshSamples = snapshot;
+
+    for (int epoch = 0; epoch < m_refreshEpochs; epoch++) {
+        m_ensemble.trainEpoch();
+    }
+
+    /*
+     * The old front is released outside the lock; it is deleted by whoever uses it last.
+     */
+    QSharedPointer< ServingFront > front( new ServingFront( m_ensemble.currentFront() ) );
+
+    {
+        QMutexLocker locker(&m_servingLock);
+
+        qSwap(m_serving, front);
+        m_refreshes++;
+    }
+}
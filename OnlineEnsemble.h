@@ -0,0 +1,109 @@
+/*
+ * An ensemble that learns from a stream of labeled samples while it serves. The last samples of the
+ * stream are kept in a sliding window; every time enough new ones have arrived, a background thread runs a
+ * short refresh of the training in progress on a snapshot of the window: a few epochs of NSGA-II, each of
+ * them training every network with RPROP on the newest samples, as NetworkEnsemble::trainEpoch() does.
+ * The training is never restarted, so the population keeps what it has learned so far.
+ *
+ * After each refresh the best front is copied and packed for evaluation (see BatchEvaluator), and
+ * replaces the serving front in one pointer swap. Classification works on whatever front is serving when
+ * it starts, which stays alive until its last reader is done with it, so inference never waits for the
+ * training. Before the first refresh there is no front, and every sample gets class 0.
+ */
+
+#ifndef ONLINEENSEMBLE_H
+#define ONLINEENSEMBLE_H
+
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <QSharedPointer>
+
+#include "Ensemble.h"
+
+class ServingFront;
+
+class OnlineEnsemble
+{
+    Q_DISABLE_COPY(OnlineEnsemble)
+
+public:
+    /*
+     * The parameters are the number of networks and of worker threads for the training, the number of
+     * samples in the window, how many new samples trigger a refresh, and how many epochs a refresh runs.
+     */
+    explicit OnlineEnsemble(int networks, int threads = QThread::idealThreadCount(), int windowSize = 600,
+                            int refreshInterval = 100, int refreshEpochs = 5);
+    virtual ~OnlineEnsemble(); /* stops the background training */
+
+    /*
+     * Starts and stops the background training; samples can be added at any time, and are used from the
+     * next refresh.
+     */
+    void start();
+    void stop();
+
+    /*
+     * Adds a copy of a labeled sample to the window, pushing out the oldest one if it is full. Can be
+     * called from any thread.
+     */
+    void addSample(const InputSample &);
+
+    /*
+     * The majority vote of the serving front on each sample, weighted as in NetworkEnsemble::test(), ties
+     * going to class 0. Can be called from any thread, during refreshes too.
+     */
+    QVector< int > classify(const QList< InputSample* > &) const;
+
+    /*
+     * Copies of the networks of the serving front, which the caller owns.
+     */
+    QList< Network* > servingFront() const;
+
+    /*
+     * How many refreshes have replaced the serving front, and how many samples have been added so far.
+     */
+    int refreshes() const;
+    int samplesSeen() const;
+
+private:
+    friend class OnlineTrainingThread;
+
+    /*
+     * The loop of the background thread: waits for enough new samples, then refreshes.
+     */
+    void run();
+    void refresh(const QList< InputSample* > &);
+
+    QSharedPointer< ServingFront > currentServingFront() const;
+
+    NetworkEnsemble m_ensemble; /* only used by the background thread */
+    int m_windowSize;
+    int m_refreshInterval;
+    int m_refreshEpochs;
+    bool m_trainingStarted;
+
+    /*
+     * The window and the state of the background thread.
+     */
+    mutable QMutex m_windowLock;
+    QWaitCondition m_samplesAdded;
+    QList< InputSample* > m_window; /* oldest first */
+    int m_newSamples;
+    int m_samplesSeen;
+    bool m_stopping;
+    QThread* m_thread;
+
+    /*
+     * The samples of the training in progress, which the ensemble points to until the next refresh.
+     */
+    QList< InputSample* > m_refreshSamples;
+
+    mutable QMutex m_servingLock; /* only held to copy or swap the pointer */
+    QSharedPointer< ServingFront > m_serving;
+    int m_refreshes;
+};
+
+#endif
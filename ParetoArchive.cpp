@@ -0,0 +1,386 @@
+#include "ParetoArchive.h"
+
+#include <QtAlgorithms>
+#include <climits>
+
+/*
+ * Orderings of the rows of a table, for the binary searches in the fronts.
+ */
+class RowLessThan
+{
+public:
+    RowLessThan(const ObjectiveTable* table)
+        : m_table(table)
+    {}
+
+    bool operator()(int row1, int row2) const
+    {
+        return m_table->lessThan(row1, row2);
+    }
+
+private:
+    const ObjectiveTable* m_table;
+};
+
+class RowLessComplexity
+{
+public:
+    RowLessComplexity(const ObjectiveTable* table)
+        : m_table(table)
+    {}
+
+    bool operator()(int row1, int row2) const
+    {
+        return m_table->complexity(row1) < m_table->complexity(row2);
+    }
+
+private:
+    const ObjectiveTable* m_table;
+};
+
+ParetoArchive::ParetoArchive()
+{}
+
+ParetoArchive::~ParetoArchive()
+{
+    qDeleteAll(m_fronts);
+}
+
+void ParetoArchive::insert(Network* network)
+{
+    if (m_table.row(network) >= 0) {
+        return;
+    }
+
+    int row = m_table.insert(network);
+
+    if (row == m_ranks.size()) {
+        m_ranks.append(-1);
+    }
+
+    insertRow(row);
+}
+
+void ParetoArchive::remove(Network* network)
+{
+    int row = m_table.row(network);
+
+    if (row < 0) {
+        return;
+    }
+
+    int rank = m_ranks[row];
+    removeAt(rank, findPosition(m_fronts[rank], row));
+    m_table.remove(row);
+}
+
+/*
+ * The row must leave its front before its objectives change, since it is found by them.
+ */
+void ParetoArchive::update(Network* network)
+{
+    int row = m_table.row(network);
+
+    if (row < 0 || !m_table.isStale(row)) {
+        return;
+    }
+
+    int rank = m_ranks[row];
+    removeAt(rank, findPosition(m_fronts[rank], row));
+
+    m_table.refresh(row);
+    insertRow(row);
+}
+
+Network* ParetoArchive::takeWorst()
+{
+    if (m_fronts.isEmpty()) {
+        return NULL;
+    }
+
+    Network* worst = m_table.network( m_fronts.last()->byCrowding.begin().value() );
+    remove(worst);
+
+    return worst;
+}
+
+QList< Network* > ParetoArchive::truncate(int size)
+{
+    QList< Network* > dropped;
+
+    while (m_table.size() > size) {
+        dropped.append( takeWorst() );
+    }
+
+    return dropped;
+}
+
+bool ParetoArchive::contains(Network* network) const
+{
+    return m_table.row(network) >= 0;
+}
+
+int ParetoArchive::size() const
+{
+    return m_table.size();
+}
+
+void ParetoArchive::clear()
+{
+    qDeleteAll(m_fronts);
+    m_fronts.clear();
+    m_table.clear();
+    m_ranks.clear();
+}
+
+int ParetoArchive::frontCount() const
+{
+    return m_fronts.size();
+}
+
+QList< Network* > ParetoArchive::front(int rank) const
+{
+    QList< Network* > networks;
+
+    if (rank >= m_fronts.size()) {
+        return networks;
+    }
+
+    Q_FOREACH (int row, m_fronts[rank]->rows) {
+        networks.append( m_table.network(row) );
+    }
+
+    return networks;
+}
+
+int ParetoArchive::rank(Network* network) const
+{
+    int row = m_table.row(network);
+    return (row < 0) ? -1 : m_ranks[row];
+}
+
+double ParetoArchive::crowdingDistance(Network* network) const
+{
+    int row = m_table.row(network);
+
+    if (row < 0) {
+        return 0;
+    }
+
+    const Front* front = m_fronts[ m_ranks[row] ];
+    return front->crowding[ findPosition(front, row) ];
+}
+
+QList< Network* > ParetoArchive::networks() const
+{
+    QList< Network* > networks;
+
+    for (int rank = 0; rank < m_fronts.size(); rank++) {
+        networks += front(rank);
+    }
+
+    return networks;
+}
+
+/*
+ * Going along the staircase by increasing complexity, each network adds the rectangle between its
+ * complexity and the next one's, below its error.
+ */
+double ParetoArchive::hypervolume() const
+{
+    if (m_fronts.isEmpty()) {
+        return 0;
+    }
+
+    const QVector< int >& rows = m_fronts.first()->rows;
+    double volume = 0;
+
+    for (int i = 0; i < rows.size(); i++) {
+        double next = (i + 1 < rows.size()) ? m_table.normalizedComplexity(rows[i + 1]) : 1.0;
+        volume += (next - m_table.normalizedComplexity(rows[i])) * (1.0 - m_table.normalizedError(rows[i]));
+    }
+
+    return volume;
+}
+
+/*
+ * The first front that doesn't dominate the row; all the following ones don't either.
+ */
+void ParetoArchive::insertRow(int row)
+{
+    int low = 0;
+    int high = m_fronts.size();
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+
+        if (isDominatedBy(m_fronts[middle], row)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    insertInto(low, row);
+}
+
+/*
+ * Of the rows not more complex than the given one, the last has the smallest error: if it doesn't
+ * dominate the row, none does.
+ */
+bool ParetoArchive::isDominatedBy(const Front* front, int row) const
+{
+    int simpler = qUpperBound(front->rows.begin(), front->rows.end(), row, RowLessComplexity(&m_table))
+                  - front->rows.begin();
+
+    if (simpler == 0) {
+        return false;
+    }
+
+    return m_table.dominates(front->rows[simpler - 1], row);
+}
+
+int ParetoArchive::findPosition(const Front* front, int row) const
+{
+    int position = qLowerBound(front->rows.begin(), front->rows.end(), row, RowLessThan(&m_table))
+                   - front->rows.begin();
+
+    while (position < front->rows.size() && front->rows[position] != row) {
+        position++;
+    }
+
+    return position;
+}
+
+/*
+ * The dominated rows are at least as complex as the given one; since the error decreases with the
+ * complexity, they are the ones before the first with a smaller error. Equal rows don't dominate each
+ * other, and are skipped.
+ */
+void ParetoArchive::dominatedRange(const Front* front, int row, int* first, int* last) const
+{
+    const QVector< int >& rows = front->rows;
+
+    *first = qLowerBound(rows.begin(), rows.end(), row, RowLessComplexity(&m_table)) - rows.begin();
+
+    while (*first < rows.size() && m_table.complexity(rows[*first]) == m_table.complexity(row)
+           && !m_table.dominates(row, rows[*first])) {
+        (*first)++;
+    }
+
+    *last = *first;
+
+    while (*last < rows.size() && m_table.dominates(row, rows[*last])) {
+        (*last)++;
+    }
+}
+
+void ParetoArchive::insertInto(int rank, int row)
+{
+    if (rank == m_fronts.size()) {
+        m_fronts.append(new Front);
+    }
+
+    Front* front = m_fronts[rank];
+
+    int first, last;
+    dominatedRange(front, row, &first, &last);
+
+    QVector< int > displaced = front->rows.mid(first, last - first);
+
+    for (int i = first; i < last; i++) {
+        front->byCrowding.remove(front->crowding[i], front->rows[i]);
+    }
+
+    front->rows.remove(first, last - first);
+    front->crowding.remove(first, last - first);
+
+    int position = qLowerBound(front->rows.begin(), front->rows.end(), row, RowLessThan(&m_table))
+                   - front->rows.begin();
+
+    front->rows.insert(position, row);
+    front->crowding.insert(position, 0);
+    front->byCrowding.insert(0, row);
+    m_ranks[row] = rank;
+
+    /*
+     * The neighbours of the removed rows changed too; rows equal to the new one may sort between them
+     * and its position, so the whole span is refreshed.
+     */
+    refreshCrowding(front, qMin(position, first) - 1, qMax(position, first) + 1);
+
+    /*
+     * The displaced rows weren't dominated by anything in the next front, which was below them.
+     */
+    Q_FOREACH (int dominated, displaced) {
+        insertInto(rank + 1, dominated);
+    }
+}
+
+void ParetoArchive::removeAt(int rank, int position)
+{
+    Front* front = m_fronts[rank];
+    int removed = front->rows[position];
+
+    front->byCrowding.remove(front->crowding[position], removed);
+    front->rows.remove(position);
+    front->crowding.remove(position);
+    m_ranks[removed] = -1;
+
+    refreshCrowding(front, position - 1, position);
+
+    /*
+     * Rows of the next front dominated by the removed one move up if nothing else in this front
+     * dominates them; their place is then taken by rows of the front after, and so on.
+     */
+    if (rank + 1 < m_fronts.size()) {
+        Front* next = m_fronts[rank + 1];
+        QVector< int > promoted;
+
+        int first, last;
+        dominatedRange(next, removed, &first, &last);
+
+        for (int i = first; i < last; i++) {
+            if (!isDominatedBy(front, next->rows[i])) {
+                promoted.append(next->rows[i]);
+            }
+        }
+
+        Q_FOREACH (int row, promoted) {
+            removeAt(rank + 1, findPosition(next, row));
+            insertInto(rank, row);
+        }
+    }
+
+    /*
+     * Only the last front can remain empty: otherwise all of the next one would have moved up.
+     */
+    if (front->rows.isEmpty()) {
+        delete m_fronts.takeAt(rank);
+    }
+}
+
+/*
+ * The crowding distance of the extremes of a front is infinite; for the others it is the sum of the
+ * distances between their two neighbours on each normalized objective.
+ */
+void ParetoArchive::refreshCrowding(Front* front, int first, int last)
+{
+    const QVector< int >& rows = front->rows;
+    int count = rows.size();
+
+    for (int i = qMax(first, 0); i <= last && i < count; i++) {
+        double crowding = INT_MAX;
+
+        if (count > 2 && i > 0 && i < count - 1) {
+            crowding = (m_table.normalizedError(rows[i - 1]) - m_table.normalizedError(rows[i + 1]))
+                       + (m_table.normalizedComplexity(rows[i + 1]) - m_table.normalizedComplexity(rows[i - 1]));
+        }
+
+        if (crowding != front->crowding[i]) {
+            front->byCrowding.remove(front->crowding[i], rows[i]);
+            front->byCrowding.insert(crowding, rows[i]);
+            front->crowding[i] = crowding;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * A population of networks sorted into Pareto fronts on the two objectives of the genetic algorithm,
+ * average error and complexity, both to be minimized, and kept sorted while networks come and go.
+ *
+ * With two objectives a front is a staircase: sorted by increasing complexity, its networks have
+ * decreasing error. So whether a front dominates a network is found with a binary search, and since a
+ * network dominated by front k is dominated by all the fronts before it, its rank is found with a binary
+ * search over the fronts. The networks a new one dominates are contiguous in its front; they move down
+ * one rank, and may push others further down. When a network is removed, the ones only it dominated move
+ * up. Since a front is sorted on both objectives at once, the crowding distance of a network only depends
+ * on its neighbours in the front, and is updated for them only; each front also indexes its networks by
+ * crowding distance. Crowding distances are computed on the normalized objectives of an ObjectiveTable,
+ * which the fronts refer to by row.
+ *
+ * The objectives are read from the networks when they are inserted: update() must be called on the
+ * networks whose error has changed since.
+ */
+
+#ifndef PARETOARCHIVE_H
+#define PARETOARCHIVE_H
+
+#include <QList>
+#include <QVector>
+#include <QMultiMap>
+
+#include "Network.h"
+#include "ObjectiveTable.h"
+
+class ParetoArchive
+{
+public:
+    explicit ParetoArchive();
+    virtual ~ParetoArchive(); /* the networks aren't deleted */
+
+    /*
+     * Inserting a network twice, or removing one that isn't there, does nothing.
+     */
+    void insert(Network *);
+    void remove(Network *);
+
+    /*
+     * Moves a network to its new place if its objectives have changed.
+     */
+    void update(Network *);
+
+    /*
+     * Removes and returns the network that NSGA-II would drop first: the most crowded one of the last
+     * front. Returns NULL if the archive is empty.
+     */
+    Network* takeWorst();
+
+    /*
+     * Drops the worst networks, one by one, until @size are left; returns the dropped ones.
+     */
+    QList< Network* > truncate(int size);
+
+    bool contains(Network *) const;
+    int size() const;
+    void clear();
+
+    /*
+     * Fronts are numbered from 0, the non-dominated networks; a front lists its networks by increasing
+     * complexity, and is empty if there is no such front.
+     */
+    int frontCount() const;
+    QList< Network* > front(int) const;
+    int rank(Network *) const;
+    double crowdingDistance(Network *) const;
+
+    /*
+     * All the networks, front by front.
+     */
+    QList< Network* > networks() const;
+
+    /*
+     * Area dominated by the first front in the normalized objective space, up to the point (1, 1): 0 for
+     * an empty archive, 1 for a network with no error and no links.
+     */
+    double hypervolume() const;
+
+private:
+    /*
+     * A front is a list of rows of the table, with their crowding distances.
+     */
+    struct Front {
+        QVector< int > rows;
+        QVector< double > crowding;
+        QMultiMap< double, int > byCrowding;
+    };
+
+    bool isDominatedBy(const Front *, int row) const;
+    int findPosition(const Front *, int row) const;
+
+    /*
+     * Rows of a front dominated by another row, as the range [first, last).
+     */
+    void dominatedRange(const Front *, int row, int* first, int* last) const;
+
+    /*
+     * Puts a row in front @rank, which must not dominate it, and moves down what the row dominates.
+     */
+    void insertInto(int rank, int row);
+
+    /*
+     * Removes the row at @position in front @rank, and moves up what only that row dominated.
+     */
+    void removeAt(int rank, int position);
+
+    void insertRow(int row);
+    void refreshCrowding(Front *, int first, int last);
+
+    ObjectiveTable m_table;
+    QList< Front* > m_fronts;
+    QVector< int > m_ranks; /* by row */
+};
+
+#endif
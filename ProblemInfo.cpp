@@ -1,4 +1,5 @@
 #include <ProblemInfo.h>
+#include <SharedDataset.h>
 #include <Utils.h>
 #include <QDir>
 
@@ -11,6 +12,7 @@ class ProblemInfoHelper
 public:
     ProblemInfoHelper()
         : q(0)
+        , source(ProblemInfo::ReadSamples)
     {}
     
     virtual ~ProblemInfoHelper()
@@ -19,21 +21,42 @@ public:
     }
     
     ProblemInfo* q;
+    ProblemInfo::SampleSource source;
+    QString key;
 };
 
 Q_GLOBAL_STATIC(ProblemInfoHelper, s_probleminfo);
 
 ProblemInfo::ProblemInfo()
+    : m_shared(0)
 {
     Q_ASSERT (!s_probleminfo()->q);
     
-    readSamples("../tictactoe");
+    if (s_probleminfo()->source == AttachToSamples) {
+        attachToSamples(s_probleminfo()->key);
+    } else {
+        readSamples("../tictactoe");
+        
+        if (s_probleminfo()->source == ReadAndPublishSamples) {
+            publishSamples(s_probleminfo()->key);
+        }
+    }
     
     s_probleminfo()->q = this;
 }
 
 ProblemInfo::~ProblemInfo()
-{}
+{
+    delete m_shared;
+}
+
+void ProblemInfo::setSampleSource(SampleSource source, const QString& key)
+{
+    Q_ASSERT (!s_probleminfo()->q);
+    
+    s_probleminfo()->source = source;
+    s_probleminfo()->key = key;
+}
 
 ProblemInfo* ProblemInfo::instance()
 {
@@ -44,13 +67,21 @@ ProblemInfo* ProblemInfo::instance()
     return s_probleminfo()->q;
 }
 
+/*
+ * Attached samples belong to the segment, and go away with it.
+ */
 void ProblemInfo::destroy()
 {
-    qDeleteAll(m_training);
-    qDeleteAll(m_test);
+    if (!m_shared || m_shared->isOwner()) {
+        qDeleteAll(m_training);
+        qDeleteAll(m_test);
+    }
     
     m_training.clear();
     m_test.clear();
+    
+    delete m_shared;
+    m_shared = 0;
 }
 
 QList< InputSample* > ProblemInfo::trainingSamples() const
@@ -63,6 +94,24 @@ QList< InputSample* > ProblemInfo::testSamples() const
     return m_test;
 }
 
+MemoryFootprint ProblemInfo::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    
+    if (m_shared) {
+        footprint += m_shared->memoryFootprint();
+        
+        if (!m_shared->isOwner()) {
+            return footprint;
+        }
+    }
+    
+    footprint.samples += (m_training.size() + m_test.size()) * MemoryFootprint::allocation( sizeof(InputSample) );
+    footprint.index += MemoryFootprint::pointerList( m_training.size() ) + MemoryFootprint::pointerList( m_test.size() );
+    
+    return footprint;
+}
+
 void ProblemInfo::readSamples(const QString& dir)
 {
     QDir sampleDir(dir);
@@ -124,4 +173,32 @@ bool ProblemInfo::randomOrder(const InputSample* s1, const InputSample* s2)
     
     double choice = randomDouble(0.0, 1.0);
     return (choice <= 0.5);
-}
\ No newline at end of file
+}
+
+/*
+ * The samples read from the disk are kept: if the segment can't be created the training goes on without
+ * it, and the workers won't find it.
+ */
+void ProblemInfo::publishSamples(const QString& key)
+{
+    m_shared = new SharedDataset;
+    
+    if (!m_shared->publish(key, m_training, m_test)) {
+        cerr << "Can't publish the samples: " << m_shared->errorString().toStdString() << endl;
+        delete m_shared;
+        m_shared = 0;
+    }
+}
+
+void ProblemInfo::attachToSamples(const QString& key)
+{
+    m_shared = new SharedDataset;
+    
+    if (!m_shared->attach(key)) {
+        cerr << "Can't attach to the samples: " << m_shared->errorString().toStdString() << endl;
+        exit(-1);
+    }
+    
+    m_training = m_shared->trainingSamples();
+    m_test = m_shared->testSamples();
+}
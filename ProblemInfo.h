@@ -8,6 +8,8 @@
 #include <QString>
 #include <QHash>
 
+#include "MemoryFootprint.h"
+
 /* Size of the input feature vector (and number of neurons in the input layer) */
 #define INPUT_SIZE  9
 
@@ -17,13 +19,25 @@
 /* Number of different classes */
 #define NUM_CLASSES 2
 
-/* Number of neurons on the hidden layer */
+/*
+ * Number of neurons on the hidden layer: the maximum is a hard limit, the others are the defaults of the
+ * configuration (see Configuration.h), like LINK_SIZE_MIN and the RPROP parameters below.
+ */
 #define HIDDEN_SIZE     10
 #define HIDDEN_SIZE_MAX 10
 #define HIDDEN_SIZE_MIN 4
 
+/* Maximum number of neurons in a network, including the fake one used for biases */
+#define MAX_NEURONS (INPUT_SIZE + OUTPUT_SIZE + HIDDEN_SIZE_MAX + 1)
+
 #define LINK_SIZE_MIN   15
 
+/*
+ * Maximum complexity of a network: input to hidden and hidden to output links, with the biases of the
+ * hidden and output neurons and those of the input neurons, which are counted too
+ */
+#define LINK_SIZE_MAX   ((INPUT_SIZE + 1) * HIDDEN_SIZE_MAX + (HIDDEN_SIZE_MAX + 1) * OUTPUT_SIZE + INPUT_SIZE)
+
 /* RPROP parameters */
 #define POSITIVE_ETA 10.2
 #define NEGATIVE_ETA 0.001
@@ -50,6 +64,8 @@ public:
     unsigned int n_class;
 };
 
+class SharedDataset;
+
 /*
  * Manages the samples for the problem
  */
@@ -61,8 +77,25 @@ class ProblemInfo
     Q_DISABLE_COPY(ProblemInfo)
     
 public:
+    /*
+     * Where the samples come from: by default they are read from the hard-disk. The process that reads
+     * them may also publish them in a shared memory segment with the given key (see SharedDataset), so
+     * that evaluation worker processes attach to it with the same key instead of reading and holding
+     * their own copy.
+     */
+    enum SampleSource {
+        ReadSamples = 0,
+        ReadAndPublishSamples,
+        AttachToSamples
+    };
+    
     virtual ~ProblemInfo();
     
+    /*
+     * Must be called before the first instance().
+     */
+    static void setSampleSource(SampleSource, const QString& key = QString());
+    
     /*
      * Returns an unique instance of this class.
      * First invocation has to read the samples from the hard-disk, so it may be slow.
@@ -84,10 +117,18 @@ public:
      */
     QList< InputSample* > testSamples() const;
     
+    /*
+     * Bytes taken by all the samples and by the lists holding them; samples in a shared segment are
+     * counted only by the process that published them.
+     */
+    MemoryFootprint memoryFootprint() const;
+    
 private:
     ProblemInfo();
     
     void readSamples(const QString &);
+    void publishSamples(const QString &);
+    void attachToSamples(const QString &);
     
     /*
      * Utility function used to randomly permute the samples in our lists. It must be static
@@ -97,6 +138,7 @@ private:
     
     QList< InputSample* > m_training;
     QList< InputSample* > m_test;
+    SharedDataset* m_shared; /* NULL unless the samples are published or attached */
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "SharedDataset.h"
+
+#include <cstring>
+#include <climits>
+
+#include <QSystemSemaphore>
+
+#define SHARED_DATASET_MAGIC   0x4e455553 /* "NEUS" */
+#define SHARED_DATASET_VERSION 1
+
+/*
+ * Held by the publisher from the creation of the segment until it is filled, and by the attachers while
+ * they check it. QSharedMemory::lock() can't do this: it is taken after create(), and an attacher could
+ * come in between and find a header not written yet.
+ */
+static QString fillingKey(const QString& key)
+{
+    return key + "/filling";
+}
+
+SharedDataset::SharedDataset()
+    : m_owner(false)
+{}
+
+SharedDataset::~SharedDataset()
+{
+    detach();
+}
+
+bool SharedDataset::publish(const QString& key, const QList< InputSample* >& training, const QList< InputSample* >& test)
+{
+    detach();
+
+    Header header;
+    header.magic = SHARED_DATASET_MAGIC;
+    header.version = SHARED_DATASET_VERSION;
+    header.inputSize = INPUT_SIZE;
+    header.sampleSize = sizeof(InputSample);
+    header.trainingCount = training.size();
+    header.testCount = test.size();
+    header.samplesOffset = sizeof(Header);
+
+    qint64 size = sizeof(Header) + ((qint64)training.size() + test.size()) * sizeof(InputSample);
+
+    if (size > INT_MAX) {
+        m_error = "The samples don't fit in a shared memory segment";
+        return false;
+    }
+
+    m_memory.setKey(key);
+    QSystemSemaphore filling(fillingKey(key), 1);
+
+    if (!filling.acquire()) {
+        m_error = filling.errorString();
+        return false;
+    }
+
+    if (!m_memory.create((int)size)) {
+        m_error = m_memory.errorString();
+        filling.release();
+        return false;
+    }
+
+    char* data = static_cast< char* >( m_memory.data() );
+    InputSample* samples = reinterpret_cast< InputSample* >(data + header.samplesOffset);
+
+    memcpy(data, &header, sizeof(Header));
+
+    Q_FOREACH (const InputSample* sample, training) {
+        *samples++ = *sample;
+    }
+
+    Q_FOREACH (const InputSample* sample, test) {
+        *samples++ = *sample;
+    }
+
+    bool mapped = mapSamples();
+    filling.release();
+
+    m_owner = true;
+    return mapped;
+}
+
+bool SharedDataset::attach(const QString& key)
+{
+    detach();
+    m_memory.setKey(key);
+    QSystemSemaphore filling(fillingKey(key), 1);
+
+    if (!filling.acquire()) {
+        m_error = filling.errorString();
+        return false;
+    }
+
+    bool attached = m_memory.attach(QSharedMemory::ReadOnly);
+
+    if (!attached) {
+        m_error = m_memory.errorString();
+    }
+
+    bool mapped = attached && mapSamples();
+    filling.release();
+
+    if (attached && !mapped) {
+        detach();
+    }
+
+    return mapped;
+}
+
+void SharedDataset::detach()
+{
+    m_training.clear();
+    m_test.clear();
+    m_owner = false;
+
+    if (m_memory.isAttached()) {
+        m_memory.detach();
+    }
+}
+
+bool SharedDataset::isAttached() const
+{
+    return m_memory.isAttached();
+}
+
+bool SharedDataset::isOwner() const
+{
+    return m_owner;
+}
+
+QList< InputSample* > SharedDataset::trainingSamples() const
+{
+    return m_training;
+}
+
+QList< InputSample* > SharedDataset::testSamples() const
+{
+    return m_test;
+}
+
+QString SharedDataset::errorString() const
+{
+    return m_error;
+}
+
+MemoryFootprint SharedDataset::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+
+    if (m_owner) {
+        footprint.samples = m_memory.size();
+    }
+
+    footprint.index = MemoryFootprint::pointerList( m_training.size() ) + MemoryFootprint::pointerList( m_test.size() );
+    return footprint;
+}
+
+bool SharedDataset::mapSamples()
+{
+    if (m_memory.size() < (int)sizeof(Header)) {
+        m_error = "The shared dataset is too small for its header";
+        return false;
+    }
+
+    Header header;
+    const char* data = static_cast< const char* >( m_memory.constData() );
+
+    memcpy(&header, data, sizeof(Header));
+
+    if (header.magic != SHARED_DATASET_MAGIC || header.version != SHARED_DATASET_VERSION
+        || header.inputSize != INPUT_SIZE || header.sampleSize != sizeof(InputSample)) {
+        m_error = "The shared dataset was published by an incompatible build";
+        return false;
+    }
+
+    quint64 count = (quint64)header.trainingCount + header.testCount;
+
+    if (header.samplesOffset + count * sizeof(InputSample) > (quint64)m_memory.size()) {
+        m_error = "The shared dataset is smaller than its header says";
+        return false;
+    }
+
+    /*
+     * The segment is read-only for attached processes, so the samples must never be written through
+     * these pointers.
+     */
+    InputSample* samples = reinterpret_cast< InputSample* >( const_cast< char* >(data) + header.samplesOffset );
+
+    for (quint32 i = 0; i < header.trainingCount; i++) {
+        m_training.append(samples++);
+    }
+
+    for (quint32 i = 0; i < header.testCount; i++) {
+        m_test.append(samples++);
+    }
+
+    return true;
+}
@@ -0,0 +1,92 @@
+/*
+ * The samples of the problem in a shared memory segment, so that evaluation worker processes on the same
+ * machine don't each read and hold their own copy: one process publishes the samples once, the others
+ * attach to the segment read-only and use the samples in place.
+ *
+ * The segment starts with a header describing its contents (format version, size of the input vector and
+ * of a sample, number of training and test samples), followed by the training and then the test samples
+ * as an array of InputSample. Attaching fails if the header doesn't match this build.
+ *
+ * The sample lists returned by an attached dataset point into the segment: they are valid until it is
+ * detached, and the samples must not be modified.
+ *
+ * ProblemInfo publishes its samples, or attaches to them, when told to (see ProblemInfo::setSampleSource()).
+ */
+
+#ifndef SHAREDDATASET_H
+#define SHAREDDATASET_H
+
+#include <QList>
+#include <QString>
+#include <QSharedMemory>
+
+#include "ProblemInfo.h"
+#include "MemoryFootprint.h"
+
+class SharedDataset
+{
+    Q_DISABLE_COPY(SharedDataset)
+
+public:
+    explicit SharedDataset();
+    virtual ~SharedDataset(); /* detaches; the segment goes away when the last process detaches */
+
+    /*
+     * Creates a segment with the given key and copies the samples into it. Returns false if the segment
+     * can't be created, for instance because the key is in use or the samples take more than INT_MAX
+     * bytes (the most QSharedMemory can create).
+     */
+    bool publish(const QString& key, const QList< InputSample* >& training, const QList< InputSample* >& test);
+
+    /*
+     * Attaches read-only to a segment published by another process. Returns false if there is none with
+     * that key, or if it was published by an incompatible build.
+     */
+    bool attach(const QString& key);
+    void detach();
+    bool isAttached() const;
+
+    /*
+     * True in the process that published the segment.
+     */
+    bool isOwner() const;
+
+    QList< InputSample* > trainingSamples() const;
+    QList< InputSample* > testSamples() const;
+
+    /*
+     * Why the last publish() or attach() failed.
+     */
+    QString errorString() const;
+
+    /*
+     * The samples are counted only in the process that published them.
+     */
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 inputSize;
+        quint32 sampleSize;
+        quint32 trainingCount;
+        quint32 testCount;
+        quint64 samplesOffset;
+    };
+
+    /*
+     * Checks the header and points the sample lists into the segment; the publisher must be done filling
+     * it.
+     */
+    bool mapSamples();
+
+    QSharedMemory m_memory;
+    bool m_owner;
+    QString m_error;
+
+    QList< InputSample* > m_training;
+    QList< InputSample* > m_test;
+};
+
+#endif
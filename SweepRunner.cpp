@@ -0,0 +1,257 @@
+#include "SweepRunner.h"
+#include "Ensemble.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <iostream>
+
+using namespace std;
+
+/* Attempts at drawing a valid configuration, for each one addRandom() adds */
+#define SWEEP_RANDOM_ATTEMPTS 100
+
+class SweepRunnerThread : public QThread
+{
+public:
+    SweepRunnerThread(SweepRunner* sweep, int runner)
+        : m_sweep(sweep)
+        , m_runner(runner)
+    {}
+
+protected:
+    virtual void run()
+    {
+        if (TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->setThreadName(QString("sweep runner %1").arg(m_runner));
+        }
+
+        m_sweep->runConfigurations();
+    }
+
+private:
+    SweepRunner* m_sweep;
+    int m_runner;
+};
+
+SweepRunner::SweepRunner(const QList< InputSample* >& training, const QList< InputSample* >& generationTest,
+                         const QList< InputSample* >& test, int threads, int threadsPerRun)
+    : m_training(training)
+    , m_generationTest(generationTest)
+    , m_test(test)
+    , m_threads( qMax(threads, 1) )
+    , m_threadsPerRun( qBound(1, threadsPerRun, qMax(threads, 1)) )
+{}
+
+SweepRunner::~SweepRunner()
+{}
+
+bool SweepRunner::addConfiguration(const Configuration& config)
+{
+    if (!config.isValid()) {
+        return false;
+    }
+
+    m_configurations.append(config);
+    return true;
+}
+
+/*
+ * The combinations are enumerated like the digits of a counter, the last parameter changing fastest.
+ */
+bool SweepRunner::addGrid(const Configuration& base, const QMap< QString, QList< double > >& values)
+{
+    QList< QString > names = values.keys();
+
+    Q_FOREACH (const QString& name, names) {
+        if (!Configuration::parameterNames().contains(name)) {
+            return false;
+        }
+    }
+
+    Q_FOREACH (const QString& name, names) {
+        if (values[name].isEmpty()) {
+            return true;
+        }
+    }
+
+    QVector< int > digits(names.size(), 0);
+
+    while (true) {
+        Configuration config = base;
+
+        for (int p = 0; p < names.size(); p++) {
+            config.setParameter(names[p], values[ names[p] ][ digits[p] ]);
+        }
+
+        addConfiguration(config);
+
+        int p = names.size() - 1;
+
+        while (p >= 0 && ++digits[p] == values[ names[p] ].size()) {
+            digits[p] = 0;
+            p--;
+        }
+
+        if (p < 0) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool SweepRunner::addRandom(const Configuration& base, const QMap< QString, QPair< double, double > >& ranges,
+                            int count)
+{
+    Q_FOREACH (const QString& name, ranges.keys()) {
+        if (!Configuration::parameterNames().contains(name)) {
+            return false;
+        }
+    }
+
+    for (int c = 0; c < count; c++) {
+        for (int attempt = 0; attempt < SWEEP_RANDOM_ATTEMPTS; attempt++) {
+            Configuration config = base;
+
+            Q_FOREACH (const QString& name, ranges.keys()) {
+                config.setParameter(name, randomDouble(ranges[name].first, ranges[name].second));
+            }
+
+            if (addConfiguration(config)) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+QList< Configuration > SweepRunner::configurations() const
+{
+    return m_configurations;
+}
+
+/*
+ * The budget is split among as many runners as there are runs of threadsPerRun workers in it.
+ */
+QList< SweepRunner::Result > SweepRunner::run()
+{
+    TRACE_SPAN("sweep", "training");
+
+    m_results.clear();
+    m_results.resize( m_configurations.size() );
+    m_next = 0;
+
+    int runners = qBound(1, m_threads / m_threadsPerRun, qMax(m_configurations.size(), 1));
+    QList< SweepRunnerThread* > threads;
+
+    for (int i = 0; i < runners; i++) {
+        threads.append( new SweepRunnerThread(this, i) );
+        threads.last()->start();
+    }
+
+    Q_FOREACH (SweepRunnerThread* thread, threads) {
+        thread->wait();
+    }
+
+    qDeleteAll(threads);
+
+    int best = 0;
+
+    for (int r = 1; r < m_results.size(); r++) {
+        if (m_results[r].accuracy > m_results[best].accuracy) {
+            best = r;
+        }
+    }
+
+    cout << ":: Sweep of " << m_results.size() << " configurations done";
+
+    if (!m_results.isEmpty()) {
+        cout << ", best accuracy " << m_results[best].accuracy << " with "
+             << m_results[best].configuration.toString().toStdString();
+    }
+
+    cout << endl;
+
+    return results();
+}
+
+QList< SweepRunner::Result > SweepRunner::results() const
+{
+    return m_results.toList();
+}
+
+void SweepRunner::runConfigurations()
+{
+    while (true) {
+        int index = m_next.fetchAndAddRelaxed(1);
+
+        if (index >= m_configurations.size()) {
+            break;
+        }
+
+        m_results[index] = runConfiguration( m_configurations[index] );
+    }
+}
+
+SweepRunner::Result SweepRunner::runConfiguration(const Configuration& config)
+{
+    TRACE_SPAN("sweep run", "training");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList< InputSample* > training = m_training;
+    QList< InputSample* > generationTest = m_generationTest;
+    QList< InputSample* > test = m_test;
+
+    NetworkEnsemble ensemble(config, m_threadsPerRun);
+    ensemble.training(training, generationTest);
+
+    Result result;
+    result.configuration = config;
+    result.accuracy = ensemble.test(test);
+
+    QList< Network* > front = ensemble.takeNetworks();
+    result.frontSize = front.size();
+    qDeleteAll(front);
+
+    result.msecs = timer.elapsed();
+
+    return result;
+}
+
+void SweepRunner::writeTable(QTextStream& out) const
+{
+    QStringList names = Configuration::parameterNames();
+
+    out << names.join("\t") << "\taccuracy\tfrontSize\tmsecs\n";
+
+    Q_FOREACH (const Result& result, m_results) {
+        Q_FOREACH (const QString& name, names) {
+            out << result.configuration.parameter(name) << "\t";
+        }
+
+        out << result.accuracy << "\t" << result.frontSize << "\t" << result.msecs << "\n";
+    }
+
+    out.flush();
+}
+
+bool SweepRunner::writeTable(const QString& path) const
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    writeTable(out);
+
+    file.close();
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+ * Runs a hyperparameter sweep in one process: a list of configurations (see Configuration.h), given one by
+ * one, as a grid or drawn at random, is trained on the same samples and tested, and the results are
+ * collected into one table.
+ *
+ * The runs share a global thread budget: each one trains its ensemble with a fixed number of workers, and
+ * as many runs as the budget allows go at the same time, each taking the next configuration when it is
+ * done with one.
+ */
+
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QVector>
+#include <QThread>
+#include <QAtomicInt>
+#include <QTextStream>
+
+#include "Configuration.h"
+#include "ProblemInfo.h"
+
+class SweepRunner
+{
+    Q_DISABLE_COPY(SweepRunner)
+
+public:
+    struct Result {
+        Configuration configuration;
+        double accuracy;  /* fraction of right answers on the test samples */
+        int frontSize;
+        qint64 msecs;     /* of training and testing */
+    };
+
+    /*
+     * The samples train the networks, measure them during the training, and test the ensembles; they are
+     * only read. Each run gets @threadsPerRun of the @threads workers.
+     */
+    explicit SweepRunner(const QList< InputSample* >& training, const QList< InputSample* >& generationTest,
+                         const QList< InputSample* >& test, int threads = QThread::idealThreadCount(),
+                         int threadsPerRun = 1);
+    virtual ~SweepRunner();
+
+    /*
+     * Adds a configuration to run; returns false, and leaves it out, if it isn't valid.
+     */
+    bool addConfiguration(const Configuration &);
+
+    /*
+     * Adds every combination of the values of some parameters, the others being those of @base; the
+     * combinations that aren't valid are left out. Returns false if a parameter is unknown.
+     */
+    bool addGrid(const Configuration& base, const QMap< QString, QList< double > >& values);
+
+    /*
+     * Adds @count configurations with each of the given parameters drawn uniformly from its [min, max]
+     * range, the others being those of @base; draws that aren't valid are tried again, a limited number
+     * of times. Returns false if a parameter is unknown.
+     */
+    bool addRandom(const Configuration& base, const QMap< QString, QPair< double, double > >& ranges, int count);
+
+    QList< Configuration > configurations() const;
+
+    /*
+     * Runs all the configurations, prints the best one, and returns the results in the same order.
+     */
+    QList< Result > run();
+    QList< Result > results() const;
+
+    /*
+     * The results as tab-separated values: a column per parameter, then the accuracy, the front size and
+     * the time, with a header line.
+     */
+    void writeTable(QTextStream &) const;
+    bool writeTable(const QString& path) const;
+
+private:
+    friend class SweepRunnerThread;
+
+    /*
+     * Takes configurations until there are none left.
+     */
+    void runConfigurations();
+    Result runConfiguration(const Configuration &);
+
+    QList< InputSample* > m_training;
+    QList< InputSample* > m_generationTest;
+    QList< InputSample* > m_test;
+    int m_threads;
+    int m_threadsPerRun;
+
+    QList< Configuration > m_configurations;
+    QVector< Result > m_results; /* each run writes its own */
+    QAtomicInt m_next;
+};
+
+#endif
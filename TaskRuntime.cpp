@@ -0,0 +1,299 @@
+#include "TaskRuntime.h"
+#include "Tracing.h"
+
+#include <QMutexLocker>
+#include <QThreadStorage>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * Index of the worker running in the current thread, if any.
+ */
+struct WorkerIndex {
+    const TaskRuntime* runtime;
+    int index;
+};
+
+static QThreadStorage< WorkerIndex* > s_workerIndex;
+
+class TaskWorker : public QThread
+{
+public:
+    TaskWorker(TaskRuntime* runtime, int index, bool pin)
+        : m_runtime(runtime)
+        , m_index(index)
+        , m_pin(pin)
+    {}
+    
+protected:
+    virtual void run()
+    {
+#ifdef Q_OS_LINUX
+        if (m_pin) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(m_index % CPU_SETSIZE, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+        }
+#endif
+        
+        WorkerIndex* workerIndex = new WorkerIndex;
+        workerIndex->runtime = m_runtime;
+        workerIndex->index = m_index;
+        s_workerIndex.setLocalData(workerIndex);
+        
+        if (TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->setThreadName(QString("worker %1").arg(m_index));
+        }
+        
+        m_runtime->workerLoop(m_index);
+    }
+    
+private:
+    TaskRuntime* m_runtime;
+    int m_index;
+    bool m_pin;
+};
+
+Task::Task()
+    : m_group(0)
+{}
+
+Task::~Task()
+{}
+
+TaskGroup::TaskGroup()
+    : m_pending(0)
+{}
+
+int TaskGroup::pending() const
+{
+    return m_pending;
+}
+
+double TaskRuntime::WorkerStats::utilization() const
+{
+    return (elapsedNsecs > 0) ? (double)busyNsecs / (double)elapsedNsecs : 0.0;
+}
+
+TaskRuntime::TaskRuntime(int workers, bool pinThreads)
+    : m_stopping(false)
+{
+    workers = qMax(workers, 1);
+    
+    m_stats.resize(workers);
+    resetStats();
+    
+    for (int i = 0; i < workers; i++) {
+        m_deques.append(new Deque);
+    }
+    
+    for (int i = 0; i < workers; i++) {
+        TaskWorker* worker = new TaskWorker(this, i, pinThreads);
+        m_workers.append(worker);
+        worker->start();
+    }
+}
+
+TaskRuntime::~TaskRuntime()
+{
+    waitForAll();
+    
+    {
+        QMutexLocker locker(&m_sleepLock);
+        m_stopping = true;
+        m_taskAvailable.wakeAll();
+    }
+    
+    Q_FOREACH (TaskWorker* worker, m_workers) {
+        worker->wait();
+    }
+    
+    qDeleteAll(m_workers);
+    qDeleteAll(m_deques);
+}
+
+int TaskRuntime::workerCount() const
+{
+    return m_workers.size();
+}
+
+void TaskRuntime::submit(Task* task, TaskGroup* group)
+{
+    int deque = -1;
+    
+    if (s_workerIndex.hasLocalData() && s_workerIndex.localData()->runtime == this) {
+        deque = s_workerIndex.localData()->index;
+    } else {
+        deque = (uint)m_nextDeque.fetchAndAddRelaxed(1) % m_deques.size();
+    }
+    
+    task->m_group = group;
+    
+    if (group) {
+        group->m_pending.fetchAndAddOrdered(1);
+    }
+    
+    m_pending.fetchAndAddOrdered(1);
+    
+    {
+        QMutexLocker locker(&m_deques[deque]->lock);
+        m_deques[deque]->tasks.append(task);
+    }
+    
+    m_queued.fetchAndAddOrdered(1);
+    
+    /*
+     * A thread waiting for a group may be the only one left to run the task, e.g. when every worker is
+     * waiting inside a task.
+     */
+    QMutexLocker locker(&m_sleepLock);
+    m_taskAvailable.wakeOne();
+    m_progress.wakeAll();
+}
+
+Task* TaskRuntime::takeTask(int worker, bool* stolen, const TaskGroup* group)
+{
+    if (worker >= 0) {
+        QMutexLocker locker(&m_deques[worker]->lock);
+        QList< Task* >& tasks = m_deques[worker]->tasks;
+        
+        for (int i = tasks.size() - 1; i >= 0; i--) {
+            if (!group || tasks[i]->m_group == group) {
+                m_queued.fetchAndAddOrdered(-1);
+                *stolen = false;
+                return tasks.takeAt(i);
+            }
+        }
+    }
+    
+    int start = (worker >= 0) ? worker + 1 : 0;
+    
+    for (int d = 0; d < m_deques.size(); d++) {
+        Deque* victim = m_deques[(start + d) % m_deques.size()];
+        QMutexLocker locker(&victim->lock);
+        
+        for (int i = 0; i < victim->tasks.size(); i++) {
+            if (!group || victim->tasks[i]->m_group == group) {
+                m_queued.fetchAndAddOrdered(-1);
+                *stolen = true;
+                return victim->tasks.takeAt(i);
+            }
+        }
+    }
+    
+    return 0;
+}
+
+void TaskRuntime::runTask(Task* task, int worker, bool stolen)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    TaskGroup* group = task->m_group;
+    task->run();
+    delete task;
+    
+    if (worker >= 0) {
+        WorkerStats& stats = m_stats[worker];
+        stats.tasks++;
+        stats.steals += stolen ? 1 : 0;
+        stats.busyNsecs += timer.nsecsElapsed();
+    }
+    
+    /*
+     * The group may be gone as soon as its count gets to 0.
+     */
+    bool groupDone = (group && group->m_pending.fetchAndAddOrdered(-1) == 1);
+    bool allDone = (m_pending.fetchAndAddOrdered(-1) == 1);
+    
+    if (groupDone || allDone) {
+        QMutexLocker locker(&m_sleepLock);
+        m_progress.wakeAll();
+    }
+}
+
+void TaskRuntime::workerLoop(int worker)
+{
+    while (true) {
+        bool stolen = false;
+        Task* task = takeTask(worker, &stolen);
+        
+        if (task) {
+            runTask(task, worker, stolen);
+            continue;
+        }
+        
+        QMutexLocker locker(&m_sleepLock);
+        
+        if (m_stopping) {
+            return;
+        }
+        
+        if (m_queued == 0) {
+            m_taskAvailable.wait(&m_sleepLock);
+        }
+    }
+}
+
+void TaskRuntime::wait(TaskGroup* group)
+{
+    waitFor(group->m_pending, group);
+}
+
+void TaskRuntime::waitForAll()
+{
+    waitFor(m_pending, NULL);
+}
+
+/*
+ * A worker waiting inside a task looks in its own deque first, where the tasks it submits go; the time
+ * spent is already counted for the task it is running.
+ */
+void TaskRuntime::waitFor(const QAtomicInt& pending, const TaskGroup* group)
+{
+    int worker = -1;
+    
+    if (s_workerIndex.hasLocalData() && s_workerIndex.localData()->runtime == this) {
+        worker = s_workerIndex.localData()->index;
+    }
+    
+    while (pending > 0) {
+        bool stolen = false;
+        Task* task = takeTask(worker, &stolen, group);
+        
+        if (task) {
+            runTask(task, -1, stolen);
+            continue;
+        }
+        
+        QMutexLocker locker(&m_sleepLock);
+        
+        if (pending > 0) {
+            m_progress.wait(&m_sleepLock);
+        }
+    }
+}
+
+TaskRuntime::WorkerStats TaskRuntime::stats(int worker) const
+{
+    WorkerStats stats = m_stats[worker];
+    stats.elapsedNsecs = m_statsTimer.nsecsElapsed();
+    
+    return stats;
+}
+
+void TaskRuntime::resetStats()
+{
+    for (int i = 0; i < m_stats.size(); i++) {
+        m_stats[i].tasks = 0;
+        m_stats[i].steals = 0;
+        m_stats[i].busyNsecs = 0;
+        m_stats[i].elapsedNsecs = 0;
+    }
+    
+    m_statsTimer.start();
+}
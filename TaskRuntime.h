@@ -0,0 +1,142 @@
+/*
+ * A small work-stealing task runtime. Each worker thread has its own deque of tasks: it takes work from the
+ * back of its deque, and when that is empty it steals from the front of the others. Tasks submitted from a
+ * worker go to its own deque, the others are spread round-robin.
+ * 
+ * Tasks are submitted and waited for in groups, so more threads can share a runtime, and a task can wait
+ * for the tasks it submits: each thread waits only for its own group, and helps running only its tasks,
+ * so it never ends up stuck in the task of another thread.
+ * 
+ * On Linux the workers can be pinned to a CPU each. Per-worker statistics (tasks run, steals, busy time)
+ * show how well the load is balanced.
+ */
+
+#ifndef TASKRUNTIME_H
+#define TASKRUNTIME_H
+
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QThread>
+#include <QAtomicInt>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+class TaskGroup;
+
+/*
+ * A unit of work; the runtime deletes it after running it.
+ */
+class Task
+{
+public:
+    Task();
+    virtual ~Task();
+    virtual void run() = 0;
+    
+private:
+    friend class TaskRuntime;
+    
+    TaskGroup* m_group;
+};
+
+/*
+ * The tasks of a group not finished yet; the group must outlive them.
+ */
+class TaskGroup
+{
+    Q_DISABLE_COPY(TaskGroup)
+    
+public:
+    TaskGroup();
+    
+    int pending() const;
+    
+private:
+    friend class TaskRuntime;
+    
+    QAtomicInt m_pending;
+};
+
+class TaskWorker;
+
+class TaskRuntime
+{
+    Q_DISABLE_COPY(TaskRuntime)
+    
+public:
+    /*
+     * Per-worker statistics, since creation or since the last resetStats(). They are updated without
+     * locking, so they are only approximate while tasks are running.
+     */
+    struct WorkerStats {
+        int tasks;
+        int steals;
+        qint64 busyNsecs;
+        qint64 elapsedNsecs;
+        
+        /*
+         * Fraction of the time spent running tasks.
+         */
+        double utilization() const;
+    };
+    
+    explicit TaskRuntime(int workers = QThread::idealThreadCount(), bool pinThreads = false);
+    virtual ~TaskRuntime(); /* waits for the submitted tasks, then stops the workers */
+    
+    int workerCount() const;
+    
+    /*
+     * Adds the task to @group, if given, and queues it.
+     */
+    void submit(Task *, TaskGroup* group = NULL);
+    
+    /*
+     * Blocks until the tasks of the group are done, running some of them in the meanwhile; can be called
+     * by a task.
+     */
+    void wait(TaskGroup *);
+    
+    /*
+     * Same, for all the submitted tasks, of any group: only for the owner of the runtime, when nobody else
+     * submits tasks (e.g. before destroying it).
+     */
+    void waitForAll();
+    
+    WorkerStats stats(int worker) const;
+    void resetStats();
+    
+private:
+    friend class TaskWorker;
+    
+    struct Deque {
+        QMutex lock;
+        QList< Task* > tasks;
+    };
+    
+    /*
+     * Takes a task from the back of the deque of @worker, or steals one from the front of another deque;
+     * @worker is -1 for threads that aren't workers. Only tasks of @group are taken, if given. Returns
+     * NULL if there are none.
+     */
+    Task* takeTask(int worker, bool* stolen, const TaskGroup* group = NULL);
+    void runTask(Task *, int worker, bool stolen);
+    void workerLoop(int worker);
+    void waitFor(const QAtomicInt& pending, const TaskGroup* group);
+    
+    QList< TaskWorker* > m_workers;
+    QVector< Deque* > m_deques;
+    QVector< WorkerStats > m_stats;
+    QElapsedTimer m_statsTimer;
+    
+    QAtomicInt m_queued;  /* tasks in the deques */
+    QAtomicInt m_pending; /* tasks submitted and not finished */
+    QAtomicInt m_nextDeque;
+    bool m_stopping;
+    
+    QMutex m_sleepLock;
+    QWaitCondition m_taskAvailable;
+    QWaitCondition m_progress; /* a group or all the tasks done, or a task submitted */
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "TernaryKernel.h"
+#include "Utils.h"
+
+/*
+ * Index of the lowest set bit of a non-zero mask.
+ */
+static inline int lowestBit(TernaryMask mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+
+    return bit;
+#endif
+}
+
+/*
+ * Adds the rows of the set bits to the hidden sums; the rows have a constant length, so the inner loop
+ * can be vectorized.
+ */
+static inline void addDeltas(const double* deltas, TernaryMask mask, double* sums)
+{
+    while (mask) {
+        const double* row = deltas + lowestBit(mask) * HIDDEN_SIZE_MAX;
+        mask &= mask - 1;
+
+        for (int h = 0; h < HIDDEN_SIZE_MAX; h++) {
+            sums[h] += row[h];
+        }
+    }
+}
+
+void packTernaryNetwork(const DenseNetwork& dense, double* record)
+{
+    double blank[INPUT_SIZE];
+    double positive[INPUT_SIZE];
+    double negative[INPUT_SIZE];
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        blank[i] = sigmoid(dense.inputBias[i]);
+        positive[i] = sigmoid(dense.inputWeights[i] + dense.inputBias[i]);
+        negative[i] = sigmoid(-dense.inputWeights[i] + dense.inputBias[i]);
+    }
+
+    for (int h = 0; h < HIDDEN_SIZE_MAX; h++) {
+        double base = dense.hiddenBias[h];
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            double weight = dense.hiddenWeights[h][i];
+            base += weight * blank[i];
+
+            record[TernaryNetworkLayout::PositiveDeltas + i * HIDDEN_SIZE_MAX + h] = weight * (positive[i] - blank[i]);
+            record[TernaryNetworkLayout::NegativeDeltas + i * HIDDEN_SIZE_MAX + h] = weight * (negative[i] - blank[i]);
+        }
+
+        record[TernaryNetworkLayout::HiddenBase + h] = base;
+        record[TernaryNetworkLayout::OutputWeights + h] = dense.outputWeights[h];
+    }
+
+    record[TernaryNetworkLayout::OutputBias] = dense.outputBias;
+}
+
+double ternaryKernel(const double* record, int hiddenCount, const TernaryBoard& board)
+{
+    double sums[HIDDEN_SIZE_MAX];
+
+    for (int h = 0; h < HIDDEN_SIZE_MAX; h++) {
+        sums[h] = record[TernaryNetworkLayout::HiddenBase + h];
+    }
+
+    addDeltas(record + TernaryNetworkLayout::PositiveDeltas, board.positive, sums);
+    addDeltas(record + TernaryNetworkLayout::NegativeDeltas, board.negative, sums);
+
+    double z = record[TernaryNetworkLayout::OutputBias];
+
+    for (int h = 0; h < hiddenCount; h++) {
+        z += record[TernaryNetworkLayout::OutputWeights + h] * sigmoid(sums[h]);
+    }
+
+    return z;
+}
@@ -0,0 +1,52 @@
+/*
+ * Evaluation kernel for packed ternary samples (see TernarySampleSet.h). An input neuron computes
+ * sigmoid(x * w + b), which can only take three values when x is -1, 0 or 1, so the whole input layer is
+ * folded into the hidden layer when the network is packed:
+ *
+ * - the base sum of each hidden neuron is its bias plus its inputs when every attribute is 0;
+ * - each attribute has two rows of deltas, one per sign, holding what the hidden sums gain when the
+ *   attribute is 1 or -1 instead of 0.
+ *
+ * The kernel then starts from the base sums and adds the row of each bit set in the masks of the sample:
+ * there is no sigmoid in the input layer, and a missing attribute (a blank cell) costs nothing.
+ *
+ * The result is the output sum BatchEvaluator gives on the unpacked sample, up to rounding: the input
+ * contributions are summed in a different order.
+ */
+
+#ifndef TERNARYKERNEL_H
+#define TERNARYKERNEL_H
+
+#include "DenseNetwork.h"
+#include "ProblemInfo.h"
+#include "TernarySampleSet.h"
+
+/*
+ * Offsets in a packed ternary record; the rows of deltas are HIDDEN_SIZE_MAX long, padded with zeros.
+ */
+template < int Inputs, int MaxHidden >
+struct TernaryLayout
+{
+    enum {
+        HiddenBase = 0,
+        OutputWeights = HiddenBase + MaxHidden,
+        OutputBias = OutputWeights + MaxHidden,
+        PositiveDeltas = OutputBias + 1,
+        NegativeDeltas = PositiveDeltas + Inputs * MaxHidden,
+        Size = NegativeDeltas + Inputs * MaxHidden
+    };
+};
+
+typedef TernaryLayout< INPUT_SIZE, HIDDEN_SIZE_MAX > TernaryNetworkLayout;
+
+/*
+ * Folds the input layer of a dense network into a record of TernaryNetworkLayout::Size weights.
+ */
+void packTernaryNetwork(const DenseNetwork &, double* record);
+
+/*
+ * The output sum of a network with the given number of hidden neurons on a packed sample.
+ */
+double ternaryKernel(const double* record, int hiddenCount, const TernaryBoard &);
+
+#endif
@@ -0,0 +1,85 @@
+#include "TernarySampleSet.h"
+
+TernarySampleSet::TernarySampleSet()
+{}
+
+TernarySampleSet::~TernarySampleSet()
+{}
+
+bool TernarySampleSet::encode(const QList< InputSample* >& samples)
+{
+    clear();
+
+    if (INPUT_SIZE > TERNARY_MAX_INPUTS) {
+        return false;
+    }
+
+    m_boards.resize(samples.size());
+    m_classes.resize(samples.size());
+
+    for (int s = 0; s < samples.size(); s++) {
+        TernaryBoard& board = m_boards[s];
+        board.positive = 0;
+        board.negative = 0;
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            double value = samples[s]->attributes[i];
+
+            if (value == 1.0) {
+                board.positive |= (TernaryMask)1 << i;
+            } else if (value == -1.0) {
+                board.negative |= (TernaryMask)1 << i;
+            } else if (value != 0.0) {
+                clear();
+                return false;
+            }
+        }
+
+        m_classes[s] = samples[s]->n_class;
+    }
+
+    return true;
+}
+
+void TernarySampleSet::clear()
+{
+    m_boards.clear();
+    m_classes.clear();
+}
+
+void TernarySampleSet::decode(int index, InputSample* sample) const
+{
+    const TernaryBoard& packed = m_boards.at(index);
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        if (packed.positive & ((TernaryMask)1 << i)) {
+            sample->attributes[i] = 1.0;
+        } else if (packed.negative & ((TernaryMask)1 << i)) {
+            sample->attributes[i] = -1.0;
+        } else {
+            sample->attributes[i] = 0.0;
+        }
+    }
+
+    sample->n_class = m_classes.at(index);
+}
+
+int TernarySampleSet::size() const
+{
+    return m_boards.size();
+}
+
+bool TernarySampleSet::isEmpty() const
+{
+    return m_boards.isEmpty();
+}
+
+MemoryFootprint TernarySampleSet::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+
+    footprint.samples = MemoryFootprint::allocation( m_boards.size() * sizeof(TernaryBoard) )
+                        + MemoryFootprint::allocation( m_classes.size() * sizeof(quint8) );
+
+    return footprint;
+}
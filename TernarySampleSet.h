@@ -0,0 +1,78 @@
+/*
+ * Samples whose attributes are all -1, 0 or 1 (like the cells of a tic-tac-toe board), packed into two bit
+ * masks each: bit i is set in the positive mask if attribute i is 1, and in the negative mask if it is -1.
+ * A board takes a few bytes instead of a whole InputSample and its pointer, so millions of them fit in
+ * cache, and the input layer can be evaluated from the set bits alone (see TernaryKernel.h).
+ *
+ * The masks are in one array and the classes in another, in the order of the sample list they come from.
+ */
+
+#ifndef TERNARYSAMPLESET_H
+#define TERNARYSAMPLESET_H
+
+#include <QList>
+#include <QVector>
+
+#include "ProblemInfo.h"
+#include "MemoryFootprint.h"
+
+/* The smallest unsigned type with a bit per attribute */
+#if INPUT_SIZE <= 16
+typedef quint16 TernaryMask;
+#elif INPUT_SIZE <= 32
+typedef quint32 TernaryMask;
+#else
+typedef quint64 TernaryMask;
+#endif
+
+/* Samples with more attributes than this can't be packed */
+#define TERNARY_MAX_INPUTS 64
+
+struct TernaryBoard
+{
+    TernaryMask positive;
+    TernaryMask negative;
+};
+
+class TernarySampleSet
+{
+public:
+    explicit TernarySampleSet();
+    virtual ~TernarySampleSet();
+
+    /*
+     * Packs the samples, replacing the previous ones. Returns false, leaving the set empty, if an
+     * attribute isn't exactly -1, 0 or 1, or if there are too many attributes.
+     */
+    bool encode(const QList< InputSample* > &);
+    void clear();
+
+    /*
+     * Unpacks a sample, e.g. to train on it.
+     */
+    void decode(int index, InputSample *) const;
+
+    int size() const;
+    bool isEmpty() const;
+
+    const TernaryBoard& board(int index) const;
+    int sampleClass(int index) const;
+
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    QVector< TernaryBoard > m_boards;
+    QVector< quint8 > m_classes;
+};
+
+inline const TernaryBoard& TernarySampleSet::board(int index) const
+{
+    return m_boards.at(index);
+}
+
+inline int TernarySampleSet::sampleClass(int index) const
+{
+    return m_classes.at(index);
+}
+
+#endif
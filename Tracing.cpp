@@ -0,0 +1,191 @@
+#include "Tracing.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QMutexLocker>
+
+class TraceRecorderHelper
+{
+public:
+    TraceRecorderHelper()
+        : q(0)
+    {}
+    
+    virtual ~TraceRecorderHelper()
+    {
+        delete q;
+    }
+    
+    TraceRecorder* q;
+};
+
+Q_GLOBAL_STATIC(TraceRecorderHelper, s_tracerecorder);
+
+QAtomicInt TraceRecorder::s_enabled(0);
+
+TraceRecorder::TraceRecorder()
+    : m_capacity(0)
+{
+    Q_ASSERT (!s_tracerecorder()->q);
+    
+    s_tracerecorder()->q = this;
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    s_enabled.fetchAndStoreOrdered(0);
+    qDeleteAll(m_buffers);
+}
+
+TraceRecorder* TraceRecorder::instance()
+{
+    if (!s_tracerecorder()->q) {
+        new TraceRecorder;
+    }
+    
+    return s_tracerecorder()->q;
+}
+
+void TraceRecorder::enable(int capacity)
+{
+    {
+        QMutexLocker locker(&m_buffersLock);
+        m_capacity = capacity;
+        
+        Q_FOREACH (TraceBuffer* buffer, m_buffers) {
+            resizeBuffer(buffer);
+        }
+    }
+    
+    m_clock.start();
+    s_enabled.fetchAndStoreOrdered(1);
+}
+
+void TraceRecorder::disable()
+{
+    s_enabled.fetchAndStoreOrdered(0);
+}
+
+qint64 TraceRecorder::now() const
+{
+    return m_clock.nsecsElapsed();
+}
+
+void TraceRecorder::setThreadName(const QString& name)
+{
+    localBuffer()->threadName = name;
+}
+
+TraceRecorder::TraceBuffer* TraceRecorder::localBuffer()
+{
+    if (!m_localBuffer.hasLocalData()) {
+        TraceBuffer* buffer = new TraceBuffer;
+        buffer->next = 0;
+        buffer->wrapped = false;
+        
+        QMutexLocker locker(&m_buffersLock);
+        resizeBuffer(buffer);
+        buffer->track = m_buffers.size() + 1;
+        buffer->threadName = QString("thread %1").arg(buffer->track);
+        m_buffers.append(buffer);
+        
+        TraceBufferRef* ref = new TraceBufferRef;
+        ref->buffer = buffer;
+        m_localBuffer.setLocalData(ref);
+    }
+    
+    return m_localBuffer.localData()->buffer;
+}
+
+/*
+ * Gives the buffer the current capacity, keeping its latest events in order; called with the lock held.
+ */
+void TraceRecorder::resizeBuffer(TraceBuffer* buffer)
+{
+    if (buffer->events.size() == m_capacity) {
+        return;
+    }
+    
+    int count = buffer->wrapped ? buffer->events.size() : buffer->next;
+    int start = buffer->wrapped ? buffer->next : 0;
+    int kept = qMin(count, m_capacity);
+    QVector< TraceEvent > events(m_capacity);
+    
+    for (int i = 0; i < kept; i++) {
+        events[i] = buffer->events[(start + count - kept + i) % buffer->events.size()];
+    }
+    
+    buffer->events = events;
+    buffer->next = (kept == m_capacity) ? 0 : kept;
+    buffer->wrapped = (kept > 0 && kept == m_capacity);
+}
+
+void TraceRecorder::record(const char* name, const char* category, qint64 begin, qint64 end, int arg)
+{
+    TraceBuffer* buffer = localBuffer();
+    
+    if (buffer->events.isEmpty()) {
+        return;
+    }
+    
+    TraceEvent& event = buffer->events[buffer->next];
+    event.name = name;
+    event.category = category;
+    event.begin = begin;
+    event.duration = end - begin;
+    event.arg = arg;
+    
+    if (++buffer->next == buffer->events.size()) {
+        buffer->next = 0;
+        buffer->wrapped = true;
+    }
+}
+
+/*
+ * Timestamps in the trace-event format are expressed in microseconds.
+ */
+bool TraceRecorder::writeJson(const QString& path)
+{
+    QFile file(path);
+    
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    
+    QTextStream out(&file);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(3);
+    out << "{\"traceEvents\":[";
+    
+    QMutexLocker locker(&m_buffersLock);
+    bool first = true;
+    
+    Q_FOREACH (TraceBuffer* buffer, m_buffers) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->track
+            << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+        first = false;
+        
+        int count = buffer->wrapped ? buffer->events.size() : buffer->next;
+        int start = buffer->wrapped ? buffer->next : 0;
+        
+        for (int i = 0; i < count; i++) {
+            const TraceEvent& event = buffer->events[(start + i) % buffer->events.size()];
+            
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->track
+                << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << event.duration / 1000.0;
+            
+            if (event.arg >= 0) {
+                out << ",\"args\":{\"id\":" << event.arg << "}";
+            }
+            
+            out << "}";
+        }
+    }
+    
+    out << "\n]}\n";
+    out.flush();
+    file.close();
+    
+    return true;
+}
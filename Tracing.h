@@ -0,0 +1,141 @@
+/*
+ * Optional timeline tracing in the Chrome trace-event format, which can be loaded in chrome://tracing
+ * or in Perfetto. Each thread records complete spans ("X" events) into its own fixed-size ring buffer,
+ * so recording never takes a lock; buffers are only collected when writeJson() is called at the end.
+ * Every thread gets its own track.
+ * 
+ * Tracing is disabled by default: a TraceSpan then only checks a flag, and records nothing.
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <QElapsedTimer>
+
+class TraceRecorder
+{
+    /*
+     * Only one instance can be present (see instance())
+     */
+    Q_DISABLE_COPY(TraceRecorder)
+    
+public:
+    virtual ~TraceRecorder();
+    
+    static TraceRecorder* instance();
+    
+    /*
+     * Checked by every span: keep it cheap.
+     */
+    static bool isEnabled()
+    {
+        return (s_enabled != 0);
+    }
+    
+    /*
+     * Starts recording; each thread keeps at most @capacity events, after which the oldest
+     * ones are overwritten. The buffers of the threads already traced are resized, keeping their
+     * latest events: no span may be recording meanwhile.
+     */
+    void enable(int capacity = 65536);
+    void disable();
+    
+    /*
+     * Name shown for the track of the calling thread.
+     */
+    void setThreadName(const QString &);
+    
+    /*
+     * Nanoseconds since tracing was enabled.
+     */
+    qint64 now() const;
+    
+    /*
+     * Records a span of the calling thread; @arg is shown in the event details, unless negative.
+     */
+    void record(const char* name, const char* category, qint64 begin, qint64 end, int arg);
+    
+    /*
+     * Collects all the buffers and writes them in a JSON file. Returns false if the file
+     * cannot be written.
+     */
+    bool writeJson(const QString &);
+    
+private:
+    TraceRecorder();
+    
+    struct TraceEvent {
+        const char* name;
+        const char* category;
+        qint64 begin;
+        qint64 duration;
+        int arg;
+    };
+    
+    struct TraceBuffer {
+        int track;
+        QString threadName;
+        QVector< TraceEvent > events;
+        int next; /* where the next event goes */
+        bool wrapped; /* true if some old events have been overwritten */
+    };
+    
+    /*
+     * QThreadStorage deletes its content when a thread exits, while the buffers must survive until
+     * they are written out: the storage only holds a reference to a buffer owned by the recorder.
+     */
+    struct TraceBufferRef {
+        TraceBuffer* buffer;
+    };
+    
+    TraceBuffer* localBuffer();
+    void resizeBuffer(TraceBuffer *);
+    
+    static QAtomicInt s_enabled;
+    
+    QElapsedTimer m_clock;
+    
+    QMutex m_buffersLock; /* guards the capacity too */
+    int m_capacity;
+    QList< TraceBuffer* > m_buffers;
+    QThreadStorage< TraceBufferRef* > m_localBuffer;
+};
+
+/*
+ * Records the enclosing scope as a span, if tracing is enabled.
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name, const char* category, int arg = -1)
+        : m_name(name)
+        , m_category(category)
+        , m_arg(arg)
+        , m_begin(TraceRecorder::isEnabled() ? TraceRecorder::instance()->now() : -1)
+    {}
+    
+    ~TraceSpan()
+    {
+        if (m_begin >= 0 && TraceRecorder::isEnabled()) {
+            TraceRecorder* recorder = TraceRecorder::instance();
+            recorder->record(m_name, m_category, m_begin, recorder->now(), m_arg);
+        }
+    }
+    
+private:
+    const char* m_name;
+    const char* m_category;
+    int m_arg;
+    qint64 m_begin;
+};
+
+#define TRACE_SPAN(name, category) TraceSpan traceSpan(name, category)
+#define TRACE_SPAN_ARG(name, category, arg) TraceSpan traceSpan(name, category, arg)
+
+#endif
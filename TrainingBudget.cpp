@@ -0,0 +1,120 @@
+#include "TrainingBudget.h"
+
+TrainingBudget::TrainingBudget(int maxEpochs)
+    : m_maxEpochs(maxEpochs)
+    , m_timeLimit(0)
+    , m_evaluationLimit(0)
+    , m_patience(0)
+    , m_minImprovement(0)
+    , m_epochs(0)
+    , m_evaluations(0)
+    , m_bestHypervolume(0)
+    , m_stagnantEpochs(0)
+    , m_stopReason(NotStopped)
+{}
+
+TrainingBudget::~TrainingBudget()
+{}
+
+void TrainingBudget::setMaxEpochs(int epochs)
+{
+    m_maxEpochs = epochs;
+}
+
+void TrainingBudget::setTimeLimit(qint64 msecs)
+{
+    m_timeLimit = msecs;
+}
+
+void TrainingBudget::setEvaluationLimit(qint64 evaluations)
+{
+    m_evaluationLimit = evaluations;
+}
+
+void TrainingBudget::setPatience(int epochs, double minImprovement)
+{
+    m_patience = epochs;
+    m_minImprovement = minImprovement;
+}
+
+void TrainingBudget::start()
+{
+    m_timer.start();
+    m_epochs = 0;
+    m_evaluations = 0;
+    m_bestHypervolume = 0;
+    m_stagnantEpochs = 0;
+    m_stopReason = NotStopped;
+}
+
+bool TrainingBudget::recordEpoch(qint64 evaluations, double hypervolume)
+{
+    m_epochs++;
+    m_evaluations += evaluations;
+
+    if (m_epochs == 1 || hypervolume >= m_bestHypervolume + m_minImprovement) {
+        m_stagnantEpochs = 0;
+    } else {
+        m_stagnantEpochs++;
+    }
+
+    m_bestHypervolume = qMax(m_bestHypervolume, hypervolume);
+
+    if (m_maxEpochs > 0 && m_epochs >= m_maxEpochs) {
+        m_stopReason = EpochLimit;
+    } else if (m_evaluationLimit > 0 && m_evaluations >= m_evaluationLimit) {
+        m_stopReason = EvaluationLimit;
+    } else if (m_timeLimit > 0 && elapsed() + elapsed() / m_epochs > m_timeLimit) {
+        m_stopReason = TimeLimit;
+    } else if (m_patience > 0 && m_stagnantEpochs >= m_patience) {
+        m_stopReason = Converged;
+    }
+
+    return m_stopReason == NotStopped;
+}
+
+TrainingBudget::StopReason TrainingBudget::stopReason() const
+{
+    return m_stopReason;
+}
+
+const char* TrainingBudget::stopReasonName(StopReason reason)
+{
+    switch (reason) {
+        case EpochLimit:
+            return "epoch limit reached";
+        case TimeLimit:
+            return "time limit reached";
+        case EvaluationLimit:
+            return "evaluation limit reached";
+        case Converged:
+            return "front converged";
+        default:
+            return "not stopped";
+    }
+}
+
+int TrainingBudget::epochs() const
+{
+    return m_epochs;
+}
+
+qint64 TrainingBudget::evaluations() const
+{
+    return m_evaluations;
+}
+
+qint64 TrainingBudget::elapsed() const
+{
+    return m_timer.isValid() ? m_timer.elapsed() : 0;
+}
+
+double TrainingBudget::bestHypervolume() const
+{
+    return m_bestHypervolume;
+}
+
+int TrainingBudget::stagnantEpochs() const
+{
+    return m_stagnantEpochs;
+}
@@ -0,0 +1,85 @@
+/*
+ * Decides when the training of an ensemble should stop. A budget can limit the number of epochs, the
+ * wall-clock time and the number of fitness evaluations (networks evaluated on the generation test set),
+ * and can stop the training once it has converged: when the hypervolume of the first Pareto front hasn't
+ * improved by at least a given amount for a number of epochs.
+ *
+ * The hypervolume is the area dominated by the front in the normalized objective space (error and
+ * complexity in [0, 1], see ObjectiveTable), up to the reference point (1, 1); it grows whenever the
+ * front gets better on either objective.
+ *
+ * The time limit is checked before an epoch starts: the training stops if the next epoch, taking as long
+ * as the average one so far, wouldn't end in time, so what is left of the time goes back to the caller.
+ */
+
+#ifndef TRAININGBUDGET_H
+#define TRAININGBUDGET_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+
+class TrainingBudget
+{
+public:
+    enum StopReason {
+        NotStopped,
+        EpochLimit,
+        TimeLimit,
+        EvaluationLimit,
+        Converged
+    };
+
+    /*
+     * Only the number of epochs is limited, by default to the 100 epochs training() has always run.
+     */
+    explicit TrainingBudget(int maxEpochs = 100);
+    virtual ~TrainingBudget();
+
+    /*
+     * A limit of 0 means no limit.
+     */
+    void setMaxEpochs(int);
+    void setTimeLimit(qint64 msecs);
+    void setEvaluationLimit(qint64);
+
+    /*
+     * Stops the training after @epochs epochs without the hypervolume growing by @minImprovement.
+     */
+    void setPatience(int epochs, double minImprovement = 0.001);
+
+    /*
+     * Starts the clock and forgets the epochs recorded so far.
+     */
+    void start();
+
+    /*
+     * Records an epoch which evaluated @evaluations networks and left a front with the given hypervolume.
+     * Returns whether the training should go on.
+     */
+    bool recordEpoch(qint64 evaluations, double hypervolume);
+
+    StopReason stopReason() const;
+    static const char* stopReasonName(StopReason);
+
+    int epochs() const;
+    qint64 evaluations() const;
+    qint64 elapsed() const; /* msecs since start() */
+    double bestHypervolume() const;
+    int stagnantEpochs() const; /* epochs since the hypervolume last improved */
+
+private:
+    int m_maxEpochs;
+    qint64 m_timeLimit;
+    qint64 m_evaluationLimit;
+    int m_patience;
+    double m_minImprovement;
+
+    QElapsedTimer m_timer;
+    int m_epochs;
+    qint64 m_evaluations;
+    double m_bestHypervolume;
+    int m_stagnantEpochs;
+    StopReason m_stopReason;
+};
+
+#endif
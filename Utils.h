@@ -6,6 +6,7 @@
 #define UTILS_H
 
 #include <QString>
+#include <cmath>
 
 /*
  * Defines the possible mutation we apply to the networks
@@ -31,4 +32,24 @@ double randomDouble(double, double);
 double gaussianMutation(double, double, double);
 double minimum(double, double);
 
+/*
+ * Activation functions of sigmoid and tangent neurons. They are inline because the evaluation kernels
+ * call them in their innermost loops.
+ */
+inline double sigmoid(double z)
+{
+    return 1.0f / (1.0f + exp(-z));
+}
+
+inline double clampedTangent(double z)
+{
+    if (z < -10.0) {
+        return -1.0;
+    } else if (z > 10.0) {
+        return 1.0;
+    }
+    
+    return tanh(z);
+}
+
 #endif
\ No newline at end of file
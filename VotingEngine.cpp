@@ -0,0 +1,272 @@
+#include "VotingEngine.h"
+#include "DenseNetwork.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+#include <QtAlgorithms>
+
+/*
+ * Votes on a range of samples, and counts the networks run.
+ */
+class VoteTask : public Task
+{
+public:
+    VoteTask(const VotingEngine* engine, const QList< InputSample* >& samples, int first, int count,
+             int* votes, qint64* consulted)
+        : m_engine(engine)
+        , m_samples(samples)
+        , m_first(first)
+        , m_count(count)
+        , m_votes(votes)
+        , m_consulted(consulted)
+    {}
+
+    virtual void run()
+    {
+        TRACE_SPAN_ARG("vote", "inference", m_first);
+        qint64 consulted = 0;
+
+        for (int s = m_first; s < m_first + m_count; s++) {
+            int networks;
+
+            m_votes[s] = m_engine->vote(m_samples[s]->attributes, &networks);
+            consulted += networks;
+        }
+
+        *m_consulted = consulted;
+    }
+
+private:
+    const VotingEngine* m_engine;
+    QList< InputSample* > m_samples;
+    int m_first;
+    int m_count;
+    int* m_votes;
+    qint64* m_consulted;
+};
+
+/*
+ * Orders network indices for voting; ties keep the order the networks were given in.
+ */
+class VotingOrderLessThan
+{
+public:
+    VotingOrderLessThan(const VotingEngine* engine)
+        : m_engine(engine)
+    {}
+
+    bool operator()(int net1, int net2) const
+    {
+        if (m_engine->m_order == VotingEngine::AgreementOrder
+            && m_engine->m_agreements[net1] != m_engine->m_agreements[net2]) {
+            return m_engine->m_agreements[net1] > m_engine->m_agreements[net2];
+        }
+
+        return m_engine->m_complexities[net1] * m_engine->m_weights[net2]
+               < m_engine->m_complexities[net2] * m_engine->m_weights[net1];
+    }
+
+private:
+    const VotingEngine* m_engine;
+};
+
+VotingEngine::VotingEngine(Order order, double margin)
+    : m_order(order)
+    , m_margin(margin)
+    , m_votedSamples(0)
+    , m_consulted(0)
+{}
+
+VotingEngine::~VotingEngine()
+{}
+
+void VotingEngine::setOrder(Order order)
+{
+    m_order = order;
+    sortNetworks();
+}
+
+VotingEngine::Order VotingEngine::order() const
+{
+    return m_order;
+}
+
+void VotingEngine::setMargin(double margin)
+{
+    m_margin = margin;
+}
+
+double VotingEngine::margin() const
+{
+    return m_margin;
+}
+
+void VotingEngine::setNetworks(const QList< Network* >& networks)
+{
+    int count = networks.size();
+
+    m_records.resize(count * NetworkLayout::Size);
+    m_kernels.resize(count);
+    m_hiddenCounts.resize(count);
+    m_complexities.resize(count);
+    m_weights.resize(count);
+    m_agreements.fill(0, count);
+
+    DenseNetwork dense;
+
+    for (int n = 0; n < count; n++) {
+        networks[n]->toDense(&dense);
+        packNetwork(dense, m_records.data() + n * NetworkLayout::Size);
+
+        m_kernels[n] = packedKernel(dense.hiddenCount);
+        m_hiddenCounts[n] = dense.hiddenCount;
+        m_complexities[n] = networks[n]->complexity();
+        m_weights[n] = networks[n]->voteWeight();
+    }
+
+    sortNetworks();
+}
+
+int VotingEngine::networkCount() const
+{
+    return m_kernels.size();
+}
+
+void VotingEngine::calibrate(const QList< InputSample* >& samples)
+{
+    int count = m_kernels.size();
+    QVector< char > classes(count);
+
+    m_agreements.fill(0, count);
+
+    int totalWeight = 0;
+
+    for (int n = 0; n < count; n++) {
+        totalWeight += m_weights[n];
+    }
+
+    Q_FOREACH (const InputSample* sample, samples) {
+        int ones = 0;
+
+        for (int n = 0; n < count; n++) {
+            double z = m_kernels[n](m_records.constData() + n * NetworkLayout::Size, m_hiddenCounts[n],
+                                    sample->attributes);
+            classes[n] = (z > 0.0) ? 1 : 0;
+            ones += classes[n] * m_weights[n];
+        }
+
+        char majority = (ones > totalWeight - ones) ? 1 : 0;
+
+        for (int n = 0; n < count; n++) {
+            if (classes[n] == majority) {
+                m_agreements[n]++;
+            }
+        }
+    }
+
+    sortNetworks();
+}
+
+/*
+ * With @remaining votes left to cast, class 1 has won if it leads by more than that, and class 0 if
+ * class 1 can at most tie.
+ */
+int VotingEngine::vote(const double input[], int* consulted) const
+{
+    int count = m_sequence.size();
+    int ones = 0;
+    int zeros = 0;
+    int next = 0;
+
+    while (next < count) {
+        int remaining = m_remainingWeights[next];
+
+        if (ones > zeros + remaining || zeros >= ones + remaining) {
+            break;
+        }
+
+        int n = m_sequence[next++];
+        double z = m_kernels[n](m_records.constData() + n * NetworkLayout::Size, m_hiddenCounts[n], input);
+
+        if (m_margin > 0.0 && qAbs( clampedTangent(z) ) < m_margin) {
+            continue;
+        }
+
+        if (z > 0.0) {
+            ones += m_weights[n];
+        } else {
+            zeros += m_weights[n];
+        }
+    }
+
+    *consulted = next;
+    return (ones > zeros) ? 1 : 0;
+}
+
+QVector< int > VotingEngine::votes(const QList< InputSample* >& samples, TaskRuntime* runtime)
+{
+    QVector< int > votes(samples.size(), 0);
+
+    int tasks = runtime ? 4 * runtime->workerCount() : 1;
+    int chunk = qMax(1, (samples.size() + tasks - 1) / tasks);
+
+    QVector< qint64 > consulted( (samples.size() + chunk - 1) / chunk, 0 );
+    TaskGroup group;
+
+    for (int first = 0, t = 0; first < samples.size(); first += chunk, t++) {
+        VoteTask* task = new VoteTask(this, samples, first, qMin(chunk, samples.size() - first),
+                                      votes.data(), &consulted[t]);
+
+        if (runtime) {
+            runtime->submit(task, &group);
+        } else {
+            task->run();
+            delete task;
+        }
+    }
+
+    if (runtime) {
+        runtime->wait(&group);
+    }
+
+    Q_FOREACH (qint64 networks, consulted) {
+        m_consulted += networks;
+    }
+
+    m_votedSamples += samples.size();
+    return votes;
+}
+
+double VotingEngine::averageConsulted() const
+{
+    return m_votedSamples ? (double)m_consulted / (double)m_votedSamples : 0.0;
+}
+
+qint64 VotingEngine::votedSamples() const
+{
+    return m_votedSamples;
+}
+
+void VotingEngine::resetStatistics()
+{
+    m_votedSamples = 0;
+    m_consulted = 0;
+}
+
+void VotingEngine::sortNetworks()
+{
+    m_sequence.resize(m_kernels.size());
+
+    for (int n = 0; n < m_sequence.size(); n++) {
+        m_sequence[n] = n;
+    }
+
+    qStableSort(m_sequence.begin(), m_sequence.end(), VotingOrderLessThan(this));
+
+    m_remainingWeights.resize(m_sequence.size());
+
+    for (int k = m_sequence.size() - 1, remaining = 0; k >= 0; k--) {
+        remaining += m_weights[ m_sequence[k] ];
+        m_remainingWeights[k] = remaining;
+    }
+}
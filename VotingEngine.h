@@ -0,0 +1,100 @@
+/*
+ * Majority voting with early exit. The networks vote one at a time, each casting as many votes as its
+ * vote weight, and the vote on a sample stops as soon as the networks left can no longer change its
+ * outcome; so the order in which they vote matters: either the cheapest votes first (by complexity per
+ * vote), or the networks most often agreeing with the majority first, as measured on some calibration
+ * samples, which tend to settle the vote sooner.
+ *
+ * Optionally a network abstains when it isn't confident enough, i.e. when its output (the clamped tangent
+ * of the output neuron) is within a margin of 0. Without a margin, the outcome is always the one of a
+ * full vote, as given by EvaluationScheduler::majorityVotes().
+ *
+ * Networks are packed and run as in BatchEvaluator (see FixedKernel.h).
+ */
+
+#ifndef VOTINGENGINE_H
+#define VOTINGENGINE_H
+
+#include <QList>
+#include <QVector>
+
+#include "Network.h"
+#include "FixedKernel.h"
+#include "TaskRuntime.h"
+
+class VotingEngine
+{
+public:
+    enum Order {
+        ComplexityOrder, /* the lowest complexity per vote first */
+        AgreementOrder   /* the networks that agree most with the majority first */
+    };
+
+    explicit VotingEngine(Order order = ComplexityOrder, double margin = 0.0);
+    virtual ~VotingEngine();
+
+    void setOrder(Order);
+    Order order() const;
+
+    /*
+     * Networks whose output is within @margin of 0 abstain; 0 makes every network vote.
+     */
+    void setMargin(double);
+    double margin() const;
+
+    /*
+     * Packs the networks and puts them in order; they are packed again by the next call only, so their
+     * weights can change in the meanwhile.
+     */
+    void setNetworks(const QList< Network* > &);
+    int networkCount() const;
+
+    /*
+     * Runs every network on the samples, and counts how often each one gives the class chosen by the
+     * majority; this is the agreement used by AgreementOrder.
+     */
+    void calibrate(const QList< InputSample* > &);
+
+    /*
+     * The class chosen by the majority of the networks that don't abstain, ties going to class 0; the
+     * number of networks run goes in @consulted. Can be called by many threads at the same time.
+     */
+    int vote(const double input[], int* consulted) const;
+
+    /*
+     * Votes on every sample, with tasks of @runtime if given, and adds to the statistics.
+     */
+    QVector< int > votes(const QList< InputSample* > &, TaskRuntime* runtime = NULL);
+
+    /*
+     * Networks run per sample by votes(), on average, since the last resetStatistics().
+     */
+    double averageConsulted() const;
+    qint64 votedSamples() const;
+    void resetStatistics();
+
+private:
+    friend class VotingOrderLessThan;
+
+    void sortNetworks();
+
+    Order m_order;
+    double m_margin;
+
+    /*
+     * By network, as given to setNetworks(); m_sequence holds the indices in voting order.
+     */
+    QVector< double > m_records;   /* [network][NetworkLayout::Size] */
+    QVector< PackedKernel > m_kernels;
+    QVector< int > m_hiddenCounts;
+    QVector< int > m_complexities;
+    QVector< int > m_weights;
+    QVector< int > m_agreements;
+    QVector< int > m_sequence;
+    QVector< int > m_remainingWeights; /* [k] is the weight of the networks from m_sequence[k] on */
+
+    qint64 m_votedSamples;
+    qint64 m_consulted;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Checks that the parameters of a Configuration come back exactly through toString() and parse(), and
+ * that SweepRunner::addGrid() enumerates the valid combinations of a grid, in order. Prints the failures,
+ * and returns the number of failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+#include <QMap>
+
+#include "Configuration.h"
+#include "SweepRunner.h"
+#include "Utils.h"
+
+using namespace std;
+
+/*
+ * Any parameter values, in range or not, come back exactly; unknown or malformed assignments are
+ * refused.
+ */
+static bool checkConfiguration()
+{
+    bool ok = true;
+
+    for (int round = 0; round < 100; round++) {
+        Configuration configuration;
+
+        Q_FOREACH (const QString& name, Configuration::parameterNames()) {
+            if (Configuration::isIntegerParameter(name)) {
+                configuration.setParameter(name, randomInteger(-1000, 1000));
+            } else {
+                configuration.setParameter(name, randomDouble(-1.0, 1.0) * pow(10.0, randomInteger(-12, 12)));
+            }
+        }
+
+        QString text = configuration.toString();
+        Configuration parsed;
+
+        if (!parsed.parse(text.split(' '))) {
+            cout << "Configuration: can't parse " << text.toStdString() << endl;
+            ok = false;
+            continue;
+        }
+
+        Q_FOREACH (const QString& name, Configuration::parameterNames()) {
+            if (parsed.parameter(name) != configuration.parameter(name)) {
+                cout << "Configuration: " << name.toStdString() << " doesn't come back from "
+                     << text.toStdString() << endl;
+                ok = false;
+            }
+        }
+    }
+
+    QStringList malformed;
+    malformed << "epochs" << "epochs=" << "epochs=ten" << "epochs=1=2" << "learningRate=0.1";
+
+    Q_FOREACH (const QString& assignment, malformed) {
+        Configuration configuration;
+        QStringList assignments;
+        assignments << assignment;
+
+        if (configuration.parse(assignments)) {
+            cout << "Configuration: " << assignment.toStdString() << " is accepted" << endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+/*
+ * The combinations come like the digits of a counter, the parameters in alphabetical order (that of the
+ * QMap) and the last one changing fastest; the invalid ones are left out, after the configurations
+ * already there.
+ */
+static bool checkGrid()
+{
+    QList< double > epochs;
+    QList< double > hiddenSizes;
+    QList< double > etas;
+    epochs << 1 << 0 << 3;          /* no epochs isn't valid */
+    hiddenSizes << 4 << 20 << 7;    /* more than HIDDEN_SIZE_MAX isn't valid */
+    etas << 1.1 << 1.3;
+
+    QMap< QString, QList< double > > values;
+    values.insert("positiveEta", etas);
+    values.insert("hiddenSize", hiddenSizes);
+    values.insert("epochs", epochs);
+
+    Configuration base;
+    base.setParameter("populationSize", 7);
+
+    QList< Configuration > expected;
+    expected.append(base);
+
+    Q_FOREACH (double e, epochs) {
+        Q_FOREACH (double h, hiddenSizes) {
+            Q_FOREACH (double eta, etas) {
+                Configuration configuration = base;
+                configuration.setParameter("epochs", e);
+                configuration.setParameter("hiddenSize", h);
+                configuration.setParameter("positiveEta", eta);
+
+                if (configuration.isValid()) {
+                    expected.append(configuration);
+                }
+            }
+        }
+    }
+
+    QList< InputSample* > none;
+    SweepRunner sweep(none, none, none);
+    sweep.addConfiguration(base);
+    bool ok = sweep.addGrid(base, values);
+    QList< Configuration > added = sweep.configurations();
+
+    if (!ok || added.size() != expected.size() || expected.size() != 1 + 2 * 2 * 2) {
+        cout << "Grid: " << added.size() - 1 << " configurations added instead of " << expected.size() - 1 << endl;
+        return false;
+    }
+
+    for (int c = 0; c < expected.size(); c++) {
+        if (added[c].toString() != expected[c].toString()) {
+            cout << "Grid: configuration " << c << " is " << added[c].toString().toStdString() << " instead of "
+                 << expected[c].toString().toStdString() << endl;
+            ok = false;
+        }
+    }
+
+    /*
+     * An unknown parameter makes the whole grid fail, even after a parameter without values; those make
+     * a grid without any combination.
+     */
+    QMap< QString, QList< double > > unknown = values;
+    unknown.insert("epochz", epochs);
+    unknown.insert("epochs", QList< double >());
+
+    QMap< QString, QList< double > > empty = values;
+    empty.insert("epochs", QList< double >());
+
+    if (sweep.addGrid(base, unknown) || !sweep.addGrid(base, empty) || sweep.configurations().size() != expected.size()) {
+        cout << "Grid: a grid with an unknown parameter or without values adds configurations" << endl;
+        ok = false;
+    }
+
+    return ok;
+}
+
+int main()
+{
+    srand(50);
+
+    int failed = 0;
+
+    if (!checkConfiguration()) {
+        failed++;
+    }
+
+    if (!checkGrid()) {
+        failed++;
+    }
+
+    return failed;
+}
@@ -0,0 +1,100 @@
+/*
+ * Checks that the folds of every repetition of a cross-validation split its shuffled samples: each sample
+ * in exactly one fold, the fold sizes differing by one at most, and the repetitions in different orders.
+ * Prints the failures, and returns the number of failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <QHash>
+
+#include "CrossValidation.h"
+#include "TestData.h"
+
+using namespace std;
+
+#define REPEATS 3
+
+static bool checkFolds(const QList< InputSample* >& samples, int folds)
+{
+    CrossValidation validation(samples, folds, REPEATS, 1);
+    validation.shuffle();
+    folds = qMax(folds, 3);
+
+    bool ok = true;
+    QList< QList< InputSample* > > orders;
+
+    for (int r = 0; r < REPEATS; r++) {
+        QHash< InputSample*, int > seen;
+        QList< InputSample* > order;
+        int smallest = samples.size();
+        int largest = 0;
+
+        for (int f = 0; f < folds; f++) {
+            QList< InputSample* > fold = validation.foldSamples(r, f);
+            smallest = qMin(smallest, fold.size());
+            largest = qMax(largest, fold.size());
+            order += fold;
+
+            Q_FOREACH (InputSample* sample, fold) {
+                seen[sample]++;
+            }
+        }
+
+        bool partition = (order.size() == samples.size() && seen.size() == samples.size());
+
+        Q_FOREACH (InputSample* sample, samples) {
+            partition = partition && (seen.value(sample) == 1);
+        }
+
+        if (!partition) {
+            cout << samples.size() << " samples in " << folds << " folds: the folds of repetition " << r
+                 << " don't hold every sample once" << endl;
+            ok = false;
+        }
+
+        if (largest - smallest > 1) {
+            cout << samples.size() << " samples in " << folds << " folds: folds of " << smallest << " to "
+                 << largest << " samples" << endl;
+            ok = false;
+        }
+
+        orders.append(order);
+    }
+
+    /*
+     * Orders of 20 samples or more are all different, unless the shuffle is broken.
+     */
+    for (int r = 0; r < REPEATS && samples.size() >= 20; r++) {
+        if (orders[r] == samples || (r > 0 && orders[r] == orders[r - 1])) {
+            cout << samples.size() << " samples in " << folds << " folds: repetition " << r << " isn't shuffled" << endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+int main()
+{
+    srand(49);
+
+    const int sampleCounts[] = { 0, 2, 10, 97, 1000 };
+    const int foldCounts[] = { 1, 3, 5, 7, 10 };
+    int failed = 0;
+
+    for (int s = 0; s < 5; s++) {
+        QList< InputSample* > samples = ternarySamples(sampleCounts[s]);
+
+        for (int f = 0; f < 5; f++) {
+            if (!checkFolds(samples, foldCounts[f])) {
+                failed++;
+            }
+        }
+
+        qDeleteAll(samples);
+    }
+
+    return failed;
+}
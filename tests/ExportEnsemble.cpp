@@ -0,0 +1,82 @@
+/*
+ * First half of the exporter test: writes the header of a few random networks, and the samples to check
+ * it on, each followed by the class of the majority vote (EvaluationScheduler::majorityVotes()) and the
+ * class given by each network (BatchEvaluator::classify()). ExportedEnsembleCheck then compiles the
+ * header and compares.
+ *
+ * Usage: ExportEnsemble <header> <samples>
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <QFile>
+#include <QTextStream>
+
+#include "BatchEvaluator.h"
+#include "EnsembleExporter.h"
+#include "EvaluationScheduler.h"
+#include "TaskRuntime.h"
+#include "TestData.h"
+
+/* must match the networkN() functions listed by ExportedEnsembleCheck */
+#define EXPORTED_NETWORKS 7
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <header> <samples>" << std::endl;
+        return 1;
+    }
+
+    srand(42);
+
+    QList< InputSample* > samples = ternarySamples(1000) + continuousSamples(1000);
+    QList< Network* > networks = randomNetworks(EXPORTED_NETWORKS, samples);
+
+    if (!EnsembleExporter("exported").writeHeader(networks, argv[1])) {
+        std::cerr << "Can't write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    TaskRuntime runtime(2);
+    EvaluationScheduler scheduler(&runtime);
+    QVector< int > votes = scheduler.majorityVotes(networks, samples);
+
+    BatchEvaluator evaluator;
+    QVector< char > classes;
+    evaluator.classify(networks, samples, classes);
+
+    QFile file(argv[2]);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::cerr << "Can't write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    QTextStream out(&file);
+    out.setRealNumberNotation(QTextStream::SmartNotation);
+    out.setRealNumberPrecision(17);
+
+    for (int s = 0; s < samples.size(); s++) {
+        for (int attr = 0; attr < INPUT_SIZE; attr++) {
+            out << samples[s]->attributes[attr] << " ";
+        }
+
+        out << votes[s];
+
+        for (int n = 0; n < networks.size(); n++) {
+            out << " " << (int) classes[n * samples.size() + s];
+        }
+
+        out << "\n";
+    }
+
+    out.flush();
+    file.close();
+
+    qDeleteAll(samples);
+    qDeleteAll(networks);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Second half of the exporter test: the header written by ExportEnsemble must give, on every sample,
+ * the class of the majority vote from classify() and the class of each network from networkN(). Built
+ * without Qt or the rest of the program, as the users of the header would build it.
+ *
+ * Usage: ExportedEnsembleCheck <samples>
+ */
+
+#include <cstdio>
+
+#include "exported.h"
+
+typedef int (*ExportedNetwork)(const double x[exported::INPUT_SIZE]);
+
+static const ExportedNetwork networks[] = {
+    exported::network0, exported::network1, exported::network2, exported::network3,
+    exported::network4, exported::network5, exported::network6
+};
+
+static_assert(sizeof(networks) / sizeof(networks[0]) == exported::NETWORK_COUNT,
+              "the networks listed here must be the ones ExportEnsemble exports");
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: %s <samples>\n", argv[0]);
+        return 1;
+    }
+
+    std::FILE* file = std::fopen(argv[1], "r");
+
+    if (file == NULL) {
+        std::fprintf(stderr, "Can't read %s\n", argv[1]);
+        return 1;
+    }
+
+    double x[exported::INPUT_SIZE];
+    int samples = 0;
+    int mismatches = 0;
+
+    while (std::fscanf(file, "%lf", &x[0]) == 1) {
+        for (int attr = 1; attr < exported::INPUT_SIZE; attr++) {
+            if (std::fscanf(file, "%lf", &x[attr]) != 1) {
+                std::fprintf(stderr, "Truncated sample %d\n", samples);
+                return 1;
+            }
+        }
+
+        int expected;
+
+        if (std::fscanf(file, "%d", &expected) != 1) {
+            std::fprintf(stderr, "Truncated sample %d\n", samples);
+            return 1;
+        }
+
+        if (exported::classify(x) != expected) {
+            std::printf("Sample %d: classify() gives %d, the ensemble %d\n", samples, exported::classify(x), expected);
+            mismatches++;
+        }
+
+        for (int n = 0; n < exported::NETWORK_COUNT; n++) {
+            if (std::fscanf(file, "%d", &expected) != 1) {
+                std::fprintf(stderr, "Truncated sample %d\n", samples);
+                return 1;
+            }
+
+            if (networks[n](x) != expected) {
+                std::printf("Sample %d: network%d() gives %d, the network %d\n", samples, n, networks[n](x), expected);
+                mismatches++;
+            }
+        }
+
+        samples++;
+    }
+
+    std::fclose(file);
+    std::printf("%d samples, %d mismatches\n", samples, mismatches);
+
+    return (samples > 0 && mismatches == 0) ? 0 : 1;
+}
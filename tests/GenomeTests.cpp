@@ -0,0 +1,539 @@
+/*
+ * Saves mutated networks with Network::save() and loads them back: the loaded network must evaluate as
+ * the saved one and be saved again to the same bytes. Every truncated genome, and genomes corrupted one
+ * field at a time (version, vote weight, layer sizes, links, slot layout), must be refused with NULL.
+ * Then the same through the files of NetworkEnsemble::saveNetworks() and loadNetworks(). Prints the
+ * failures, and returns the number of failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+
+#include "Ensemble.h"
+#include "Network.h"
+#include "Neuron.h"
+#include "DenseNetwork.h"
+#include "Utils.h"
+
+using namespace std;
+
+#define NETWORKS 200
+#define SAVED_NETWORKS 5
+#define SAVED_FILE "GenomeTests.saved"
+
+/*
+ * The fields of a saved genome, in the order Network::save() writes them.
+ */
+struct GenomeLink
+{
+    qint32 in;
+    qint32 out;
+    double weight;
+    double output;
+};
+
+struct Genome
+{
+    quint32 version;
+    double averageError;
+    qint32 voteWeight;
+    QList< qint32 > generations;
+    QList< qint32 > freeSlots;
+    QList< qint32 > layers[3];
+    QList< GenomeLink > links;
+
+    bool read(const QByteArray& bytes)
+    {
+        QDataStream stream(bytes);
+        qint32 count;
+
+        stream >> version >> averageError >> voteWeight >> count;
+
+        for (int i = 0; i < count; i++) {
+            qint32 generation;
+            stream >> generation;
+            generations.append(generation);
+        }
+
+        stream >> count;
+
+        for (int i = 0; i < count; i++) {
+            qint32 id;
+            stream >> id;
+            freeSlots.append(id);
+        }
+
+        for (int l = 0; l < 3; l++) {
+            stream >> count;
+
+            for (int i = 0; i < count; i++) {
+                qint32 id;
+                stream >> id;
+                layers[l].append(id);
+            }
+        }
+
+        stream >> count;
+
+        for (int i = 0; i < count; i++) {
+            GenomeLink link;
+            stream >> link.in >> link.out >> link.weight >> link.output;
+            links.append(link);
+        }
+
+        return (stream.status() == QDataStream::Ok && stream.atEnd());
+    }
+
+    QByteArray write() const
+    {
+        QByteArray bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+
+        stream << version << averageError << voteWeight << (qint32)generations.size();
+
+        Q_FOREACH (qint32 generation, generations) {
+            stream << generation;
+        }
+
+        stream << (qint32)freeSlots.size();
+
+        Q_FOREACH (qint32 id, freeSlots) {
+            stream << id;
+        }
+
+        for (int l = 0; l < 3; l++) {
+            stream << (qint32)layers[l].size();
+
+            Q_FOREACH (qint32 id, layers[l]) {
+                stream << id;
+            }
+        }
+
+        stream << (qint32)links.size();
+
+        Q_FOREACH (const GenomeLink& link, links) {
+            stream << link.in << link.out << link.weight << link.output;
+        }
+
+        return bytes;
+    }
+
+    /*
+     * Drops a neuron from its layer, with its links.
+     */
+    void removeNeuron(int layer, qint32 id)
+    {
+        layers[layer].removeAll(id);
+
+        for (int i = links.size() - 1; i >= 0; i--) {
+            if (links[i].in == id || links[i].out == id) {
+                links.removeAt(i);
+            }
+        }
+    }
+
+    void addLink(qint32 in, qint32 out)
+    {
+        GenomeLink link = { in, out, 0.5, 0.0 };
+        links.append(link);
+    }
+};
+
+static QByteArray saved(const Network* network)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    network->save(stream);
+
+    return bytes;
+}
+
+static Network* loaded(const QByteArray& bytes)
+{
+    QDataStream stream(bytes);
+
+    return Network::load(stream, 1);
+}
+
+static bool sameDense(const DenseNetwork& a, const DenseNetwork& b)
+{
+    bool same = (a.hiddenCount == b.hiddenCount && a.outputBias == b.outputBias);
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        same = same && (a.inputWeights[i] == b.inputWeights[i] && a.inputBias[i] == b.inputBias[i]);
+    }
+
+    for (int h = 0; h < a.hiddenCount && h < HIDDEN_SIZE_MAX; h++) {
+        same = same && (a.hiddenBias[h] == b.hiddenBias[h] && a.outputWeights[h] == b.outputWeights[h]);
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            same = same && (a.hiddenWeights[h][i] == b.hiddenWeights[h][i]);
+        }
+    }
+
+    return same;
+}
+
+/*
+ * The loaded network evaluates as the saved one, keeps its error, vote weight and handles, and saves to
+ * the same bytes; two genomes in a row load one after the other.
+ */
+static bool checkRoundTrip(const Network* network)
+{
+    QByteArray bytes = saved(network);
+    Network* copy = loaded(bytes);
+
+    if (!copy) {
+        cout << "Round trip: a saved network can't be loaded" << endl;
+        return false;
+    }
+
+    DenseNetwork dense, copyDense;
+    network->toDense(&dense);
+    copy->toDense(&copyDense);
+
+    bool ok = (sameDense(dense, copyDense) && copy->isConsistent() && saved(copy) == bytes
+               && copy->averageError() == network->averageError() && copy->voteWeight() == network->voteWeight()
+               && copy->complexity() == network->complexity());
+
+    for (int id = 0; id < MAX_NEURONS && ok; id++) {
+        if (network->getNeuron(id)) {
+            ok = (copy->getNeuron( network->neuronHandle(id) ) == copy->getNeuron(id));
+        }
+    }
+
+    delete copy;
+
+    QByteArray twice = bytes + bytes;
+    QDataStream stream(twice);
+    Network* first = Network::load(stream, 1);
+    Network* second = Network::load(stream, 2);
+    ok = ok && first && second && stream.atEnd() && saved(second) == bytes;
+
+    delete first;
+    delete second;
+
+    if (!ok) {
+        cout << "Round trip: the loaded network differs from the saved one" << endl;
+    }
+
+    return ok;
+}
+
+static bool checkTruncated(const QByteArray& bytes)
+{
+    for (int size = 0; size < bytes.size(); size++) {
+        Network* network = loaded(bytes.left(size));
+
+        if (network) {
+            cout << "Truncated: a genome cut after " << size << " of " << bytes.size() << " bytes is loaded" << endl;
+            delete network;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Each corruption of a genome with at least two hidden neurons and a free slot.
+ */
+static bool checkCorrupted(const QByteArray& bytes)
+{
+    Genome genome;
+
+    if (!genome.read(bytes) || genome.layers[1].size() < 2 || genome.freeSlots.isEmpty()) {
+        cout << "Corrupted: can't read the genome back" << endl;
+        return false;
+    }
+
+    qint32 input = genome.layers[0].first();
+    qint32 hidden = genome.layers[1].first();
+    qint32 otherHidden = genome.layers[1].last();
+    qint32 output = genome.layers[2].first();
+    qint32 freeSlot = genome.freeSlots.first();
+
+    const char* names[] = {
+        "version 0", "next version", "vote weight 0",
+        "an input neuron missing", "no output neuron", "two output neurons",
+        "a hidden to hidden link", "an input to output link", "a link to the bias", "a link to a free slot",
+        "a duplicate link", "a missing bias link",
+        "a neuron in a free slot", "a slot beyond the last one", "a free slot listed twice",
+        "an empty slot not listed", "too few slots"
+    };
+
+    const int corruptions = sizeof(names) / sizeof(names[0]);
+    bool ok = true;
+
+    for (int c = 0; c < corruptions; c++) {
+        Genome corrupted = genome;
+
+        switch (c) {
+            case 0: corrupted.version = 0; break;
+            case 1: corrupted.version++; break;
+            case 2: corrupted.voteWeight = 0; break;
+            case 3: corrupted.removeNeuron(0, input); break;
+            case 4: corrupted.removeNeuron(2, output); break;
+            case 5:
+                corrupted.removeNeuron(1, otherHidden);
+                corrupted.layers[2].append(otherHidden);
+                corrupted.addLink(BIAS_NEURON_ID, otherHidden);
+                break;
+            case 6: corrupted.addLink(hidden, otherHidden); break;
+            case 7: corrupted.addLink(input, output); break;
+            case 8: corrupted.addLink(hidden, BIAS_NEURON_ID); break;
+            case 9: corrupted.addLink(hidden, freeSlot); break;
+            case 10: corrupted.links.append(corrupted.links.last()); break;
+            case 11:
+                for (int i = 0; i < corrupted.links.size(); i++) {
+                    if (corrupted.links[i].in == BIAS_NEURON_ID && corrupted.links[i].out == hidden) {
+                        corrupted.links.removeAt(i);
+                        break;
+                    }
+                }
+                break;
+            case 12: corrupted.freeSlots.append(hidden); break;
+            case 13: corrupted.freeSlots.append(corrupted.generations.size()); break;
+            case 14: corrupted.freeSlots.append(freeSlot); break;
+            case 15: corrupted.freeSlots.removeAll(freeSlot); break;
+            case 16: corrupted.generations.removeLast(); break;
+        }
+
+        Network* network = loaded( corrupted.write() );
+
+        if (network) {
+            cout << "Corrupted: a genome with " << names[c] << " is loaded" << endl;
+            delete network;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool checkGenomes()
+{
+    int failures = 0;
+    int corrupted = 0;
+
+    for (int n = 0; n < NETWORKS && failures < 10; n++) {
+        Network* network = new Network(n + 1);
+        int mutations = randomInteger(0, 100);
+
+        for (int m = 0; m < mutations; m++) {
+            network->mutate((MutationOperator) randomInteger(RemoveLink, WeightMutation + 1));
+        }
+
+        network->setAverageError( randomDouble(0.0, 1.0) );
+        network->setVoteWeight( randomInteger(1, 4) );
+
+        QByteArray bytes = saved(network);
+        Genome genome;
+
+        if (!checkRoundTrip(network) || (n % 20 == 0 && !checkTruncated(bytes))) {
+            failures++;
+        }
+
+        if (genome.read(bytes) && genome.layers[1].size() >= 2 && !genome.freeSlots.isEmpty() && corrupted < 10) {
+            corrupted++;
+
+            if (!checkCorrupted(bytes)) {
+                failures++;
+            }
+        }
+
+        delete network;
+    }
+
+    if (corrupted == 0) {
+        cout << "No network had two hidden neurons and a free slot to corrupt" << endl;
+        failures++;
+    }
+
+    return (failures == 0);
+}
+
+static bool writeFile(const QByteArray& bytes)
+{
+    QFile file(SAVED_FILE);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    bool ok = (file.write(bytes) == bytes.size());
+    file.close();
+
+    return ok;
+}
+
+static QByteArray readFile()
+{
+    QFile file(SAVED_FILE);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+static bool sameNetwork(const Network* a, const Network* b)
+{
+    DenseNetwork aDense, bDense;
+    a->toDense(&aDense);
+    b->toDense(&bDense);
+
+    return (sameDense(aDense, bDense) && a->averageError() == b->averageError());
+}
+
+/*
+ * Loads the saved networks into an ensemble asking for @populationSize networks: the first ones saved
+ * come first, then clones of them in turn, each with the error of its parent but mutated; all get new
+ * IDs and a vote weight of 1.
+ */
+static bool checkLoadedPopulation(const QList< Network* >& saved, int populationSize)
+{
+    NetworkEnsemble ensemble(2, 2);
+
+    if (!ensemble.loadNetworks(SAVED_FILE, populationSize)) {
+        cout << "Load networks: can't load " << SAVED_FILE << endl;
+        return false;
+    }
+
+    QList< Network* > networks = ensemble.takeNetworks();
+    int kept = qMin(populationSize, saved.size());
+    bool ok = (networks.size() == populationSize);
+    QList< int > ids;
+
+    for (int n = 0; n < networks.size() && ok; n++) {
+        const Network* parent = saved[n % kept];
+
+        if (n < kept) {
+            ok = sameNetwork(networks[n], parent);
+        } else {
+            ok = (!sameNetwork(networks[n], parent) && networks[n]->averageError() == parent->averageError());
+        }
+
+        ok = ok && (networks[n]->voteWeight() == 1 && networks[n]->isConsistent() && !ids.contains(networks[n]->id()));
+        ids.append( networks[n]->id() );
+    }
+
+    if (!ok) {
+        cout << "Load networks: wrong population of " << networks.size() << " networks for " << populationSize
+             << " asked from " << saved.size() << " saved" << endl;
+    }
+
+    ensemble.setNetworks(networks);
+
+    return ok;
+}
+
+/*
+ * A file that can't be read, or only in part, leaves the networks of the ensemble alone.
+ */
+static bool checkBadFiles(const QByteArray& bytes, int firstGenomeSize)
+{
+    const char* names[] = { "A missing file", "A file with a wrong magic number", "A file with no network",
+                            "A truncated file", "A file with a corrupted genome" };
+    const int files = sizeof(names) / sizeof(names[0]);
+    bool ok = true;
+
+    for (int f = 0; f < files; f++) {
+        QByteArray corrupted = bytes;
+
+        switch (f) {
+            case 0: QFile::remove(SAVED_FILE); break;
+            case 1: corrupted[0] = corrupted[0] ^ 1; break;
+            case 2: corrupted = bytes.left(12); corrupted[11] = 0; break;
+            case 3: corrupted = bytes.left(bytes.size() - 1); break;
+            case 4: corrupted[12 + firstGenomeSize + 3] = 2; break; /* the version of the second genome */
+        }
+
+        if (f > 0 && !writeFile(corrupted)) {
+            cout << "Load networks: can't write " << SAVED_FILE << endl;
+            return false;
+        }
+
+        NetworkEnsemble ensemble(3, 2);
+        QList< Network* > before = ensemble.takeNetworks();
+        QList< QByteArray > genomes;
+
+        Q_FOREACH (const Network* network, before) {
+            genomes.append( saved(network) );
+        }
+
+        ensemble.setNetworks(before);
+        bool loaded = ensemble.loadNetworks(SAVED_FILE, 4);
+        QList< Network* > after = ensemble.takeNetworks();
+        bool unchanged = (after == before);
+
+        for (int n = 0; n < after.size() && unchanged; n++) {
+            unchanged = (saved(after[n]) == genomes[n]);
+        }
+
+        ensemble.setNetworks(after);
+
+        if (loaded || !unchanged) {
+            cout << "Load networks: " << names[f] << (loaded ? " is loaded" : " changes the ensemble") << endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool checkLoadNetworks()
+{
+    QList< Network* > networks;
+
+    for (int n = 0; n < SAVED_NETWORKS; n++) {
+        Network* network = new Network(n + 1);
+
+        for (int m = 0; m < 20; m++) {
+            network->mutate((MutationOperator) randomInteger(RemoveLink, WeightMutation + 1));
+        }
+
+        network->setAverageError(0.1 * (n + 1));
+        network->setVoteWeight( randomInteger(1, 4) );
+        networks.append(network);
+    }
+
+    NetworkEnsemble ensemble(2, 2);
+    ensemble.setNetworks(networks);
+
+    if (!ensemble.saveNetworks(SAVED_FILE)) {
+        cout << "Load networks: can't save " << SAVED_FILE << endl;
+        return false;
+    }
+
+    bool ok = checkLoadedPopulation(networks, 3);
+    ok = checkLoadedPopulation(networks, SAVED_NETWORKS) && ok;
+    ok = checkLoadedPopulation(networks, 12) && ok;
+    ok = checkBadFiles(readFile(), saved(networks.first()).size()) && ok;
+
+    QFile::remove(SAVED_FILE);
+
+    return ok;
+}
+
+int main()
+{
+    srand(38);
+
+    int failed = 0;
+
+    if (!checkGenomes()) {
+        failed++;
+    }
+
+    if (!checkLoadNetworks()) {
+        failed++;
+    }
+
+    return failed;
+}
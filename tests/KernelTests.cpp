@@ -0,0 +1,153 @@
+/*
+ * Checks of the evaluation paths that must agree with each other: the packed ternary samples against the
+ * unpacked ones, and the kernels specialized by FixedKernel against genericKernel(). Prints the
+ * mismatches, and returns the number of failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+#include "BatchEvaluator.h"
+#include "FixedKernel.h"
+#include "TernarySampleSet.h"
+#include "TestData.h"
+
+using namespace std;
+
+/*
+ * A packed sample can only get another class when the output is so close to 0 that the order of the sums
+ * decides its sign.
+ */
+static bool checkTernaryClasses(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    TernarySampleSet packed;
+
+    if (!packed.encode(samples)) {
+        cout << "Ternary samples: can't pack the samples" << endl;
+        return false;
+    }
+
+    BatchEvaluator evaluator;
+    QVector< char > classes;
+    QVector< char > ternaryClasses;
+    evaluator.classify(networks, samples, classes);
+    evaluator.classify(networks, packed, ternaryClasses);
+
+    DenseNetwork dense;
+    double record[NetworkLayout::Size];
+    int mismatches = 0;
+
+    for (int n = 0; n < networks.size(); n++) {
+        networks[n]->toDense(&dense);
+        packNetwork(dense, record);
+
+        for (int s = 0; s < samples.size(); s++) {
+            int index = n * samples.size() + s;
+
+            if (ternaryClasses[index] != classes[index] &&
+                fabs(genericKernel(record, dense.hiddenCount, samples[s]->attributes)) > 1e-9) {
+                mismatches++;
+            }
+        }
+    }
+
+    if (mismatches > 0) {
+        cout << "Ternary samples: " << mismatches << " classes differ from the unpacked samples" << endl;
+    }
+
+    return (mismatches == 0);
+}
+
+/*
+ * The unrolled kernels do the sums in the order of genericKernel(), so the outputs must be equal to the
+ * bit, for every hidden count and for the networks actually made by the mutations.
+ */
+static bool checkFixedKernels(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    QList< DenseNetwork > denseNetworks;
+    DenseNetwork dense;
+
+    for (int hidden = 0; hidden <= HIDDEN_SIZE_MAX; hidden++) {
+        dense.hiddenCount = hidden;
+        dense.outputBias = randomDouble(-8.0, 8.0);
+
+        for (int i = 0; i < INPUT_SIZE; i++) {
+            dense.inputWeights[i] = randomDouble(-8.0, 8.0);
+            dense.inputBias[i] = randomDouble(-8.0, 8.0);
+        }
+
+        for (int h = 0; h < HIDDEN_SIZE_MAX; h++) {
+            dense.hiddenBias[h] = (h < hidden) ? randomDouble(-8.0, 8.0) : 0.0;
+            dense.outputWeights[h] = (h < hidden) ? randomDouble(-8.0, 8.0) : 0.0;
+
+            for (int i = 0; i < INPUT_SIZE; i++) {
+                dense.hiddenWeights[h][i] = (h < hidden) ? randomDouble(-8.0, 8.0) : 0.0;
+            }
+        }
+
+        denseNetworks.append(dense);
+    }
+
+    Q_FOREACH (const Network* network, networks) {
+        network->toDense(&dense);
+        denseNetworks.append(dense);
+    }
+
+    double record[NetworkLayout::Size];
+    int specialized = 0;
+    int mismatches = 0;
+
+    for (int hidden = 0; hidden <= HIDDEN_SIZE_MAX; hidden++) {
+        if (packedKernel(hidden) != &genericKernel) {
+            specialized++;
+        }
+    }
+
+    Q_FOREACH (const DenseNetwork& network, denseNetworks) {
+        PackedKernel kernel = packedKernel(network.hiddenCount);
+        packNetwork(network, record);
+
+        Q_FOREACH (const InputSample* sample, samples) {
+            if (kernel(record, network.hiddenCount, sample->attributes) !=
+                genericKernel(record, network.hiddenCount, sample->attributes)) {
+                mismatches++;
+            }
+        }
+    }
+
+    if (specialized == 0) {
+        cout << "Fixed kernels: no hidden count has a specialized kernel" << endl;
+    }
+
+    if (mismatches > 0) {
+        cout << "Fixed kernels: " << mismatches << " outputs differ from genericKernel()" << endl;
+    }
+
+    return (specialized > 0 && mismatches == 0);
+}
+
+int main()
+{
+    srand(7);
+
+    QList< InputSample* > ternary = ternarySamples(2000);
+    QList< InputSample* > continuous = continuousSamples(2000);
+    QList< Network* > networks = randomNetworks(9, ternary.mid(0, 200));
+
+    int failed = 0;
+
+    if (!checkTernaryClasses(networks, ternary)) {
+        failed++;
+    }
+
+    if (!checkFixedKernels(networks, ternary + continuous)) {
+        failed++;
+    }
+
+    qDeleteAll(ternary);
+    qDeleteAll(continuous);
+    qDeleteAll(networks);
+
+    return failed;
+}
@@ -0,0 +1,158 @@
+/*
+ * Applies long random sequences of mutations, and checks after each one that the network is still
+ * consistent (neuron store, link slots and links agree), and that the handles to its neurons resolve as they should: to the same neuron while it
+ * lives, to NULL once it has been removed (even if a new neuron took its slot), on the network and on
+ * its copies. Prints the failures, and returns the number of failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include "Network.h"
+#include "Neuron.h"
+#include "Utils.h"
+
+using namespace std;
+
+#define NETWORKS 100
+#define MUTATIONS 200
+
+/*
+ * Live handles must resolve to the neuron in the slot of their ID, dead ones to nothing.
+ */
+static bool checkHandles(const Network* network, const QList< NeuronHandle >& live, const QList< NeuronHandle >& dead)
+{
+    Q_FOREACH (const NeuronHandle& handle, live) {
+        if (!network->getNeuron(handle) || network->getNeuron(handle) != network->getNeuron( handle.id() )) {
+            return false;
+        }
+    }
+
+    Q_FOREACH (const NeuronHandle& handle, dead) {
+        if (network->getNeuron(handle)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * The removable links must be exactly the links between input and hidden or hidden and output neurons;
+ * isConsistent() checks the same against the slots of the free links.
+ */
+static bool checkLinks(const Network* network)
+{
+    QList< QPair< int, int > > removable = network->removableLinks();
+    int links = 0;
+
+    for (int in = 0; in < MAX_NEURONS; in++) {
+        for (int out = 0; out < MAX_NEURONS; out++) {
+            Neuron* predecessor = network->getNeuron(in);
+            Neuron* successor = network->getNeuron(out);
+
+            if (!predecessor || !successor || in == BIAS_NEURON_ID || !network->getLink(in, out)) {
+                continue;
+            }
+
+            bool adjacent = (predecessor->layer() == Neuron::InputLayer && successor->layer() == Neuron::HiddenLayer)
+                    || (predecessor->layer() == Neuron::HiddenLayer && successor->layer() == Neuron::OutputLayer);
+
+            if (!adjacent || !removable.contains( qMakePair(in, out) )) {
+                return false;
+            }
+
+            links++;
+        }
+    }
+
+    return (links == removable.size());
+}
+
+static bool checkMutations()
+{
+    int failures = 0;
+    int removed = 0;
+
+    for (int n = 0; n < NETWORKS && failures < 10; n++) {
+        Network* network = new Network(n + 1);
+        QList< NeuronHandle > live;
+        QList< NeuronHandle > dead;
+
+        for (int step = 0; step <= MUTATIONS && failures < 10; step++) {
+            if (step > 0 && step % 25 == 0 && !network->removableLinks().isEmpty()) {
+                QList< QPair< int, int > > removable = network->removableLinks();
+                QPair< int, int > link = removable[ randomInteger(0, removable.size()) ];
+                network->removeLink(link.first, link.second);
+            } else if (step > 0) {
+                network->mutate((MutationOperator) randomInteger(RemoveLink, WeightMutation + 1));
+            }
+
+            if (!network->isConsistent() || !checkLinks(network)) {
+                cout << "Network " << n << ": inconsistent after " << step << " mutations" << endl;
+                failures++;
+            }
+
+            /*
+             * A mutation removes or adds at most one neuron, and never in the same slot: a live handle
+             * whose neuron is gone has been removed, and any neuron without a live handle is new.
+             */
+            for (int h = live.size() - 1; h >= 0; h--) {
+                if (!network->getNeuron( live[h].id() )) {
+                    dead.append( live.takeAt(h) );
+                    removed++;
+                }
+            }
+
+            for (int id = 0; id < MAX_NEURONS; id++) {
+                bool known = false;
+
+                Q_FOREACH (const NeuronHandle& handle, live) {
+                    known = known || (handle.id() == id);
+                }
+
+                if (network->getNeuron(id) && !known) {
+                    live.append( network->neuronHandle(id) );
+                }
+            }
+
+            if (!checkHandles(network, live, dead)) {
+                cout << "Network " << n << ": wrong handles after " << step << " mutations" << endl;
+                failures++;
+            }
+
+            if (step % 10 == 0) {
+                Network* copy = new Network(network, network->id());
+
+                if (!copy->isConsistent() || !checkHandles(copy, live, dead)) {
+                    cout << "Network " << n << ": wrong copy after " << step << " mutations" << endl;
+                    failures++;
+                }
+
+                delete copy;
+            }
+        }
+
+        delete network;
+    }
+
+    if (removed == 0) {
+        cout << "No neuron was ever removed" << endl;
+        failures++;
+    }
+
+    return (failures == 0);
+}
+
+int main()
+{
+    srand(30);
+
+    int failed = 0;
+
+    if (!checkMutations()) {
+        failed++;
+    }
+
+    return failed;
+}
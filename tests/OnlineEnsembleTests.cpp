@@ -0,0 +1,216 @@
+/*
+ * Streams samples into an OnlineEnsemble while other threads classify, during the refreshes and across the
+ * swaps of the serving front. A classification must always be the majority vote of one whole front: the
+ * one serving when it started, if no swap came before it was done. The serving front must be replaced
+ * after each refresh, and stay after the training stops. Prints the failures, and returns the number of
+ * failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <QThread>
+#include <QElapsedTimer>
+
+#include "OnlineEnsemble.h"
+#include "EvaluationScheduler.h"
+#include "TaskRuntime.h"
+#include "DenseNetwork.h"
+#include "TestData.h"
+
+using namespace std;
+
+#define REFRESHES 8
+#define READERS 3
+
+/*
+ * The majority vote of a front, through EvaluationScheduler rather than the packed front of the ensemble;
+ * no front at all gives class 0.
+ */
+static QVector< int > majority(TaskRuntime* runtime, const QList< Network* >& front, const QList< InputSample* >& samples)
+{
+    if (front.isEmpty()) {
+        return QVector< int >(samples.size(), 0);
+    }
+
+    return EvaluationScheduler(runtime).majorityVotes(front, samples);
+}
+
+static bool sameFront(const QList< Network* >& front1, const QList< Network* >& front2)
+{
+    if (front1.size() != front2.size()) {
+        return false;
+    }
+
+    for (int n = 0; n < front1.size(); n++) {
+        DenseNetwork dense1, dense2;
+        front1[n]->toDense(&dense1);
+        front2[n]->toDense(&dense2);
+
+        if (dense1.hiddenCount != dense2.hiddenCount || dense1.outputBias != dense2.outputBias
+            || front1[n]->voteWeight() != front2[n]->voteWeight()) {
+            return false;
+        }
+
+        for (int h = 0; h < dense1.hiddenCount; h++) {
+            if (dense1.outputWeights[h] != dense2.outputWeights[h] || dense1.hiddenBias[h] != dense2.hiddenBias[h]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Classifies over and over; a classification is checked when the refresh count didn't change around it,
+ * since the front it used is then the one copied before.
+ */
+class ReaderThread : public QThread
+{
+public:
+    ReaderThread(const OnlineEnsemble* online, const QList< InputSample* >& samples, QAtomicInt* stop)
+        : m_online(online)
+        , m_samples(samples)
+        , m_stop(stop)
+        , m_runtime(1)
+        , m_checked(0)
+        , m_mismatches(0)
+    {}
+
+    int checked() const
+    {
+        return m_checked;
+    }
+
+    int mismatches() const
+    {
+        return m_mismatches;
+    }
+
+protected:
+    virtual void run()
+    {
+        while (*m_stop == 0) {
+            int before = m_online->refreshes();
+            QList< Network* > front = m_online->servingFront();
+            QVector< int > votes = m_online->classify(m_samples);
+
+            if (m_online->refreshes() == before) {
+                m_checked++;
+
+                if (votes != majority(&m_runtime, front, m_samples)) {
+                    m_mismatches++;
+                }
+            }
+
+            qDeleteAll(front);
+        }
+    }
+
+private:
+    const OnlineEnsemble* m_online;
+    QList< InputSample* > m_samples;
+    QAtomicInt* m_stop;
+    TaskRuntime m_runtime;
+    int m_checked;
+    int m_mismatches;
+};
+
+static bool checkOnlineEnsemble()
+{
+    QList< InputSample* > stream = ternarySamples(1000);
+    QList< InputSample* > samples = ternarySamples(100) + continuousSamples(100);
+    OnlineEnsemble online(6, 2, 200, 50, 1);
+    bool ok = true;
+
+    if (online.refreshes() != 0 || !online.servingFront().isEmpty() || online.classify(samples) != QVector< int >(samples.size(), 0)) {
+        cout << "Before the first refresh, there is a front or samples of class 1" << endl;
+        ok = false;
+    }
+
+    QAtomicInt stop(0);
+    QList< ReaderThread* > readers;
+
+    for (int r = 0; r < READERS; r++) {
+        readers.append( new ReaderThread(&online, samples, &stop) );
+        readers.last()->start();
+    }
+
+    online.start();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList< Network* > front;
+    int fronts = 0;
+    int swaps = 0;
+
+    for (int s = 0; online.refreshes() < REFRESHES && !timer.hasExpired(60000); s++) {
+        online.addSample(*stream[s % stream.size()]);
+
+        if (s % 10 == 0) {
+            QThread::yieldCurrentThread();
+        }
+
+        if (online.refreshes() > fronts) {
+            QList< Network* > next = online.servingFront();
+            fronts = online.refreshes();
+            swaps += (next.isEmpty() || sameFront(front, next)) ? 0 : 1;
+
+            qDeleteAll(front);
+            front = next;
+        }
+    }
+
+    stop = 1;
+
+    Q_FOREACH (ReaderThread* reader, readers) {
+        reader->wait();
+
+        if (reader->checked() == 0 || reader->mismatches() > 0) {
+            cout << "Readers: " << reader->mismatches() << " of " << reader->checked()
+                 << " classifications aren't the votes of the serving front" << endl;
+            ok = false;
+        }
+    }
+
+    qDeleteAll(readers);
+    online.stop();
+
+    if (online.refreshes() < REFRESHES || swaps < 2) {
+        cout << online.refreshes() << " refreshes, and the serving front was replaced " << swaps << " times" << endl;
+        ok = false;
+    }
+
+    /*
+     * The last front keeps serving once the training has stopped.
+     */
+    TaskRuntime runtime(1);
+    QList< Network* > last = online.servingFront();
+
+    if (last.isEmpty() || online.classify(samples) != majority(&runtime, last, samples)) {
+        cout << "After the training, the serving front is gone or doesn't vote as its networks" << endl;
+        ok = false;
+    }
+
+    qDeleteAll(last);
+    qDeleteAll(front);
+    qDeleteAll(stream);
+    qDeleteAll(samples);
+
+    return ok;
+}
+
+int main()
+{
+    srand(47);
+
+    int failed = 0;
+
+    if (!checkOnlineEnsemble()) {
+        failed++;
+    }
+
+    return failed;
+}
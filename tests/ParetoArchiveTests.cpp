@@ -0,0 +1,385 @@
+/*
+ * Runs random sequences of insertions, updates, removals, takeWorst() and truncate() on a ParetoArchive,
+ * and after each step compares its fronts, ranks and crowding distances with a brute force non-dominated
+ * sort of the same networks, and its hypervolume with the area under the networks computed from scratch.
+ * The hypervolume is also checked on fronts known by hand. Prints the failures, and returns the number of
+ * failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+
+#include <QHash>
+#include <QtAlgorithms>
+
+#include "ParetoArchive.h"
+#include "Utils.h"
+
+using namespace std;
+
+#define POOL_SIZE 300
+#define STEPS 3000
+
+static bool dominates(Network* a, Network* b)
+{
+    return (a->averageError() < b->averageError() && a->complexity() <= b->complexity())
+            || (a->complexity() < b->complexity() && a->averageError() <= b->averageError());
+}
+
+/*
+ * By increasing complexity, then increasing error, as in a front.
+ */
+static bool frontOrder(Network* a, Network* b)
+{
+    if (a->complexity() != b->complexity()) {
+        return a->complexity() < b->complexity();
+    }
+
+    return a->averageError() < b->averageError();
+}
+
+static bool sameObjectives(Network* a, Network* b)
+{
+    return (a->complexity() == b->complexity() && a->averageError() == b->averageError());
+}
+
+/*
+ * The crowding distances of a front sorted by frontOrder(), as ParetoArchive defines them.
+ */
+static QVector< double > crowdingDistances(const QList< Network* >& front)
+{
+    QVector< double > crowding(front.size(), INT_MAX);
+
+    for (int i = 1; front.size() > 2 && i < front.size() - 1; i++) {
+        crowding[i] = (front[i - 1]->averageError() - front[i + 1]->averageError())
+                      + ((double)front[i + 1]->complexity() / LINK_SIZE_MAX - (double)front[i - 1]->complexity() / LINK_SIZE_MAX);
+    }
+
+    return crowding;
+}
+
+/*
+ * Networks with the same objectives may be in any order within a front, and swap their crowding
+ * distances: those are compared as a set, one group of equal networks at a time.
+ */
+static bool sameCrowding(const ParetoArchive& archive, const QList< Network* >& front)
+{
+    QVector< double > expected = crowdingDistances(front);
+
+    for (int first = 0, last = 0; first < front.size(); first = last) {
+        QList< double > expectedGroup;
+        QList< double > actualGroup;
+
+        for (last = first; last < front.size() && sameObjectives(front[first], front[last]); last++) {
+            expectedGroup.append(expected[last]);
+            actualGroup.append( archive.crowdingDistance(front[last]) );
+        }
+
+        qSort(expectedGroup);
+        qSort(actualGroup);
+
+        for (int i = 0; i < expectedGroup.size(); i++) {
+            if (fabs(expectedGroup[i] - actualGroup[i]) > 1e-12) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Peels off the non-dominated networks, front after front, and compares with the archive.
+ */
+static bool checkArchive(const ParetoArchive& archive, const QList< Network* >& networks, const char* step)
+{
+    QList< Network* > rest = networks;
+    int rank = 0;
+
+    if (archive.size() != networks.size()) {
+        cout << step << ": " << archive.size() << " networks instead of " << networks.size() << endl;
+        return false;
+    }
+
+    while (!rest.isEmpty()) {
+        QList< Network* > front;
+        QList< Network* > dominated;
+
+        Q_FOREACH (Network* a, rest) {
+            bool isDominated = false;
+
+            Q_FOREACH (Network* b, rest) {
+                isDominated = isDominated || dominates(b, a);
+            }
+
+            (isDominated ? dominated : front).append(a);
+        }
+
+        qSort(front.begin(), front.end(), frontOrder);
+        QList< Network* > actual = archive.front(rank);
+
+        if (actual.size() != front.size()) {
+            cout << step << ": front " << rank << " has " << actual.size() << " networks instead of " << front.size() << endl;
+            return false;
+        }
+
+        for (int i = 0; i < front.size(); i++) {
+            if (archive.rank(front[i]) != rank || !sameObjectives(actual[i], front[i])) {
+                cout << step << ": wrong network in front " << rank << endl;
+                return false;
+            }
+        }
+
+        if (!sameCrowding(archive, front)) {
+            cout << step << ": wrong crowding distances in front " << rank << endl;
+            return false;
+        }
+
+        rest = dominated;
+        rank++;
+    }
+
+    if (archive.frontCount() != rank) {
+        cout << step << ": " << archive.frontCount() << " fronts instead of " << rank << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * The crowding distances of the last front, before takeWorst() or truncate() drop from it.
+ */
+static QHash< Network*, double > lastFront(const ParetoArchive& archive)
+{
+    QHash< Network*, double > crowding;
+
+    Q_FOREACH (Network* network, archive.front(archive.frontCount() - 1)) {
+        crowding.insert(network, archive.crowdingDistance(network));
+    }
+
+    return crowding;
+}
+
+/*
+ * The worst network is one of the most crowded of the last front.
+ */
+static bool isWorst(const QHash< Network*, double >& last, Network* network)
+{
+    if (!last.contains(network)) {
+        return false;
+    }
+
+    Q_FOREACH (double crowding, last) {
+        if (crowding < last.value(network)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * The area dominated by the networks in the unit square of normalized complexity and error, summed over
+ * the intervals between their complexities.
+ */
+static double areaUnder(const QList< Network* >& networks)
+{
+    QList< double > bounds;
+    bounds.append(1.0);
+
+    Q_FOREACH (Network* network, networks) {
+        bounds.append((double)network->complexity() / LINK_SIZE_MAX);
+    }
+
+    qSort(bounds);
+    double area = 0;
+
+    for (int i = 0; i + 1 < bounds.size(); i++) {
+        double height = 0;
+
+        Q_FOREACH (Network* network, networks) {
+            if ((double)network->complexity() / LINK_SIZE_MAX <= bounds[i]) {
+                height = qMax(height, 1.0 - network->averageError());
+            }
+        }
+
+        area += (bounds[i + 1] - bounds[i]) * height;
+    }
+
+    return area;
+}
+
+/*
+ * Errors are picked on a coarse grid and complexities come from a few mutations, so that many networks
+ * share their objectives.
+ */
+static double randomError()
+{
+    return randomInteger(0, 21) / 20.0;
+}
+
+static bool checkRandomSteps()
+{
+    QList< Network* > pool;
+
+    for (int n = 0; n < POOL_SIZE; n++) {
+        Network* network = new Network(n + 1);
+        int mutations = randomInteger(0, 40);
+
+        for (int m = 0; m < mutations; m++) {
+            network->mutate((MutationOperator) randomInteger(RemoveLink, WeightMutation + 1));
+        }
+
+        network->setAverageError( randomError() );
+        pool.append(network);
+    }
+
+    ParetoArchive archive;
+    QList< Network* > inside;
+    bool ok = true;
+
+    for (int step = 0; step < STEPS && ok; step++) {
+        int operation = randomInteger(0, 18);
+        const char* name = "insert";
+
+        if (operation < 10 || inside.isEmpty()) {
+            Network* network = pool[ randomInteger(0, pool.size()) ];
+
+            if (!inside.contains(network)) {
+                inside.append(network);
+            }
+
+            archive.insert(network);
+        } else if (operation < 11) {
+            name = "remove";
+            Network* network = inside.takeAt( randomInteger(0, inside.size()) );
+            archive.remove(network);
+            ok = ok && (archive.rank(network) == -1 && !archive.contains(network));
+        } else if (operation < 16) {
+            name = "update";
+            Network* network = inside[ randomInteger(0, inside.size()) ];
+            network->setAverageError( randomError() );
+            archive.update(network);
+        } else if (operation < 17) {
+            name = "takeWorst";
+            QHash< Network*, double > last = lastFront(archive);
+            Network* taken = archive.takeWorst();
+            ok = (isWorst(last, taken) && inside.removeOne(taken) && !archive.contains(taken));
+        } else {
+            name = "truncate";
+            int size = qMax(0, inside.size() - randomInteger(1, 10));
+            int oldSize = archive.size();
+            QList< Network* > dropped = archive.truncate(size);
+            ok = (dropped.size() == oldSize - size);
+
+            Q_FOREACH (Network* network, dropped) {
+                ok = ok && (inside.removeOne(network) && !archive.contains(network));
+            }
+        }
+
+        if (!ok) {
+            cout << "Step " << step << " (" << name << "): wrong result" << endl;
+        }
+
+        ok = ok && checkArchive(archive, inside, name);
+
+        if (ok && fabs(archive.hypervolume() - areaUnder(inside)) > 1e-9) {
+            cout << name << ": hypervolume " << archive.hypervolume() << " instead of " << areaUnder(inside) << endl;
+            ok = false;
+        }
+    }
+
+    qDeleteAll(pool);
+
+    return ok;
+}
+
+/*
+ * A copy of the network with links removed until it has the given complexity.
+ */
+static Network* withComplexity(const Network* network, int complexity, double error)
+{
+    Network* copy = new Network(network, network->id());
+
+    while (copy->complexity() > complexity && !copy->removableLinks().isEmpty()) {
+        QPair< int, int > link = copy->removableLinks().first();
+        copy->removeLink(link.first, link.second);
+    }
+
+    copy->setAverageError(error);
+
+    return copy;
+}
+
+/*
+ * A fully connected network has the complexity LINK_SIZE_MAX and so no hypervolume; for a staircase
+ * front the hypervolume is the sum of its steps, whatever the dominated networks behind it.
+ */
+static bool checkHypervolume()
+{
+    Network* full = new Network(1);
+
+    for (int m = 0; m < 1000; m++) {
+        full->mutate(AddNeuron);
+        full->mutate(AddLink);
+    }
+
+    if (full->complexity() != LINK_SIZE_MAX) {
+        cout << "A fully connected network has " << full->complexity() << " links instead of " << LINK_SIZE_MAX << endl;
+        delete full;
+        return false;
+    }
+
+    struct Objectives {
+        int complexity;
+        double error;
+    };
+
+    const Objectives staircase[] = { {30, 0.6}, {60, 0.3}, {90, 0.0}, {30, 0.6}, {45, 0.8}, {90, 0.5}, {120, 0.0} };
+    const double volumes[] = { 0.3, 0.45, 0.525, 0.525, 0.525, 0.525, 0.525 };
+
+    QList< Network* > networks;
+    ParetoArchive archive;
+    bool ok = (archive.hypervolume() == 0);
+
+    full->setAverageError(0.5);
+    archive.insert(full);
+    ok = ok && (archive.hypervolume() == 0);
+    archive.remove(full);
+
+    for (int i = 0; i < 7; i++) {
+        networks.append( withComplexity(full, staircase[i].complexity, staircase[i].error) );
+        archive.insert(networks.last());
+
+        if (networks.last()->complexity() != staircase[i].complexity || fabs(archive.hypervolume() - volumes[i]) > 1e-12) {
+            cout << "Hypervolume " << archive.hypervolume() << " instead of " << volumes[i] << " with " << (i + 1)
+                 << " networks of the staircase" << endl;
+            ok = false;
+        }
+    }
+
+    qDeleteAll(networks);
+    delete full;
+
+    return ok;
+}
+
+int main()
+{
+    srand(36);
+
+    int failed = 0;
+
+    if (!checkRandomSteps()) {
+        failed++;
+    }
+
+    if (!checkHypervolume()) {
+        failed++;
+    }
+
+    return failed;
+}
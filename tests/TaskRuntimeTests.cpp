@@ -0,0 +1,170 @@
+/*
+ * Checks that waiting for a group of tasks only waits for that group: another thread sharing the runtime
+ * isn't held up by tasks that aren't its own, and tasks can wait for the tasks they submit, however few
+ * workers there are. A failure shows up as a wrong result or as a hang, caught by the ctest timeout.
+ * Returns the number of failed checks.
+ */
+
+#include <iostream>
+
+#include <QThread>
+#include <QSemaphore>
+
+#include "TaskRuntime.h"
+
+using namespace std;
+
+class BlockedTask : public Task
+{
+public:
+    explicit BlockedTask(QSemaphore* release)
+        : m_release(release)
+    {}
+
+    virtual void run()
+    {
+        m_release->acquire();
+    }
+
+private:
+    QSemaphore* m_release;
+};
+
+class CountTask : public Task
+{
+public:
+    explicit CountTask(QAtomicInt* count)
+        : m_count(count)
+    {}
+
+    virtual void run()
+    {
+        m_count->fetchAndAddOrdered(1);
+    }
+
+private:
+    QAtomicInt* m_count;
+};
+
+/*
+ * Counts the leaves of a tree of tasks, each node waiting for its children.
+ */
+class TreeTask : public Task
+{
+public:
+    TreeTask(TaskRuntime* runtime, int depth, QAtomicInt* leaves)
+        : m_runtime(runtime)
+        , m_depth(depth)
+        , m_leaves(leaves)
+    {}
+
+    virtual void run()
+    {
+        if (m_depth == 0) {
+            m_leaves->fetchAndAddOrdered(1);
+            return;
+        }
+
+        TaskGroup children;
+
+        for (int i = 0; i < 4; i++) {
+            m_runtime->submit(new TreeTask(m_runtime, m_depth - 1, m_leaves), &children);
+        }
+
+        m_runtime->wait(&children);
+    }
+
+private:
+    TaskRuntime* m_runtime;
+    int m_depth;
+    QAtomicInt* m_leaves;
+};
+
+/*
+ * Submits tasks that stay blocked until the other thread is done waiting for its own.
+ */
+class BlockingThread : public QThread
+{
+public:
+    BlockingThread(TaskRuntime* runtime, QSemaphore* release)
+        : m_runtime(runtime)
+        , m_release(release)
+    {}
+
+protected:
+    virtual void run()
+    {
+        TaskGroup group;
+
+        for (int i = 0; i < 2; i++) {
+            m_runtime->submit(new BlockedTask(m_release), &group);
+        }
+
+        m_runtime->wait(&group);
+    }
+
+private:
+    TaskRuntime* m_runtime;
+    QSemaphore* m_release;
+};
+
+static bool checkSharedRuntime(int workers)
+{
+    TaskRuntime runtime(workers);
+    QSemaphore release;
+    BlockingThread other(&runtime, &release);
+    other.start();
+
+    TaskGroup group;
+    QAtomicInt count(0);
+
+    for (int i = 0; i < 100; i++) {
+        runtime.submit(new CountTask(&count), &group);
+    }
+
+    runtime.wait(&group);
+    bool ok = (count == 100 && group.pending() == 0);
+
+    release.release(2);
+    other.wait();
+
+    if (!ok) {
+        cout << "Shared runtime with " << workers << " workers: " << (int) count << " of 100 tasks done" << endl;
+    }
+
+    return ok;
+}
+
+static bool checkNestedWaits(int workers)
+{
+    TaskRuntime runtime(workers);
+    TaskGroup group;
+    QAtomicInt leaves(0);
+
+    runtime.submit(new TreeTask(&runtime, 4, &leaves), &group);
+    runtime.wait(&group);
+
+    if (leaves != 256) {
+        cout << "Nested waits with " << workers << " workers: " << (int) leaves << " of 256 leaves" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int failed = 0;
+
+    for (int workers = 1; workers <= 4; workers *= 2) {
+        if (!checkSharedRuntime(workers)) {
+            failed++;
+        }
+
+        if (!checkNestedWaits(workers)) {
+            failed++;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,94 @@
+/*
+ * Samples and networks shared by the tests. Everything is drawn from rand(), so a test seeded with
+ * srand() sees the same data on every run.
+ */
+
+#ifndef TESTDATA_H
+#define TESTDATA_H
+
+#include <QList>
+
+#include "Network.h"
+#include "ProblemInfo.h"
+#include "Utils.h"
+
+/*
+ * Samples with attributes in {-1, 0, 1}, like the tic-tac-toe boards, of the class given by the sign of
+ * their sum.
+ */
+inline QList< InputSample* > ternarySamples(int count)
+{
+    QList< InputSample* > samples;
+    
+    for (int s = 0; s < count; s++) {
+        InputSample* sample = new InputSample;
+        int sum = 0;
+        
+        for (int attr = 0; attr < INPUT_SIZE; attr++) {
+            sample->attributes[attr] = randomInteger(-1, 2);
+            sum += (int) sample->attributes[attr];
+        }
+        
+        sample->n_class = (sum > 0) ? 1 : 0;
+        samples.append(sample);
+    }
+    
+    return samples;
+}
+
+/*
+ * Samples with attributes anywhere in [-1, 1], and a random class.
+ */
+inline QList< InputSample* > continuousSamples(int count)
+{
+    QList< InputSample* > samples;
+    
+    for (int s = 0; s < count; s++) {
+        InputSample* sample = new InputSample;
+        
+        for (int attr = 0; attr < INPUT_SIZE; attr++) {
+            sample->attributes[attr] = randomDouble(-1.0, 1.0);
+        }
+        
+        sample->n_class = randomInteger(0, 2);
+        samples.append(sample);
+    }
+    
+    return samples;
+}
+
+/*
+ * Random networks of every shape the mutations make, with vote weights from 1 to 3; with @samples, only
+ * the ones giving both classes on them are kept, so that the votes aren't all the same.
+ */
+inline QList< Network* > randomNetworks(int count, const QList< InputSample* >& samples = QList< InputSample* >())
+{
+    QList< Network* > networks;
+    
+    for (int id = 1; networks.size() < count; id++) {
+        Network* network = new Network(id);
+        int mutations = randomInteger(0, 40);
+        
+        for (int m = 0; m < mutations; m++) {
+            network->mutate((MutationOperator) randomInteger(RemoveLink, WeightMutation + 1));
+        }
+        
+        int ones = 0;
+        
+        Q_FOREACH (const InputSample* sample, samples) {
+            ones += network->predict(sample->attributes);
+        }
+        
+        if (!samples.isEmpty() && (ones == 0 || ones == samples.size())) {
+            delete network;
+            continue;
+        }
+        
+        network->setVoteWeight(randomInteger(1, 4));
+        networks.append(network);
+    }
+    
+    return networks;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Checks that the early exit votes of VotingEngine, in either order and with or without a runtime, give
+ * the classes of the full votes of EvaluationScheduler. Prints the mismatches, and returns the number of
+ * failed checks.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include "EvaluationScheduler.h"
+#include "TaskRuntime.h"
+#include "VotingEngine.h"
+#include "TestData.h"
+
+using namespace std;
+
+/*
+ * Without a margin, stopping the vote early never changes its outcome, in either order and with or
+ * without a runtime.
+ */
+static bool checkVotes(const QList< Network* >& networks, const QList< InputSample* >& samples)
+{
+    TaskRuntime runtime(2);
+    EvaluationScheduler scheduler(&runtime);
+    QVector< int > expected = scheduler.majorityVotes(networks, samples);
+
+    VotingEngine complexityVoting(VotingEngine::ComplexityOrder, 0.0);
+    VotingEngine agreementVoting(VotingEngine::AgreementOrder, 0.0);
+    complexityVoting.setNetworks(networks);
+    agreementVoting.setNetworks(networks);
+    agreementVoting.calibrate(samples);
+
+    QList< QVector< int > > votes;
+    votes << complexityVoting.votes(samples) << complexityVoting.votes(samples, &runtime)
+          << agreementVoting.votes(samples) << agreementVoting.votes(samples, &runtime);
+
+    bool ok = true;
+
+    for (int v = 0; v < votes.size(); v++) {
+        int mismatches = 0;
+
+        for (int s = 0; s < samples.size(); s++) {
+            if (votes[v][s] != expected[s]) {
+                mismatches++;
+            }
+        }
+
+        if (mismatches > 0) {
+            cout << "Votes: " << mismatches << " votes of the " << (v < 2 ? "complexity" : "agreement")
+                 << " order" << (v % 2 == 0 ? "" : " with a runtime") << " differ from majorityVotes()" << endl;
+            ok = false;
+        }
+    }
+
+    if (complexityVoting.averageConsulted() >= networks.size()) {
+        cout << "Votes: the votes never stopped early" << endl;
+        ok = false;
+    }
+
+    return ok;
+}
+
+int main()
+{
+    srand(43);
+
+    QList< InputSample* > samples = ternarySamples(2000) + continuousSamples(2000);
+    QList< Network* > networks = randomNetworks(9, samples.mid(0, 200));
+
+    int failed = 0;
+
+    if (!checkVotes(networks, samples)) {
+        failed++;
+    }
+
+    qDeleteAll(samples);
+    qDeleteAll(networks);
+
+    return failed;
+}